@@ -0,0 +1,507 @@
+// Headless benchmark of every algorithm over synthetic point distributions
+//
+// Usage: Benchmark [--algorithms a,b,...] [--distributions d,e,...]
+//                  [--sizes n,m,...] [--repeat k] [--seed s] [--threads t]
+//
+//   algorithms:    hull, hull-cull, hull-chain, hull-chain-cull, hull-chan, hull-chan-cull,
+//                  hull-incremental,
+//                  delaunay, delaunay-brio, delaunay-compact, delaunay-dc, delaunay-cdt,
+//                  delaunay-refine, delaunay-dynamic,
+//                  polygon, polygon-batch
+//   distributions: uniform, clustered, circular, collinear, grid
+//   sizes:         point counts, scientific notation accepted (1e6)
+//   threads:       threads of the parallel algorithms, 0 (default) uses all
+//
+// One CSV row per phase is written to stdout:
+//   algorithm,distribution,points,threads,repeat,phase,ms,mpts_per_s,output_size,peak_rss_kb
+// peak_rss_kb is the high-water mark of the whole process,
+// run a single size per process to attribute it to one configuration
+
+// Platform headers come first, common.h pulls in namespace std
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "ConvexHull.h"
+#include "DelaunayTriangulation.h"
+#include "IncrementalConvexHull.h"
+#include "ParallelDelaunayTriangulation.h"
+#include "PolygonTriangulation.h"
+
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+
+size_t peakRssKb()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return counters.PeakWorkingSetSize / 1024;
+	}
+	return 0;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+	// Reported in bytes on macOS
+	return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+	return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+std::vector<std::string> splitList(const std::string& list)
+{
+	std::vector<std::string> items;
+	std::stringstream ss(list);
+	std::string item;
+	while (std::getline(ss, item, ','))
+	{
+		if (!item.empty())
+		{
+			items.push_back(item);
+		}
+	}
+	return items;
+}
+
+bool generatePoints(const std::string& distribution, size_t count, uint32_t seed,
+					std::vector<Vector2f>& outPoints)
+{
+	std::mt19937 gen(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	outPoints.clear();
+	outPoints.reserve(count);
+
+	if (distribution == "uniform")
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			outPoints.emplace_back(unit(gen), unit(gen));
+		}
+	}
+	else if (distribution == "clustered")
+	{
+		// Gaussian blobs around a few random centers
+		const size_t cClusterCount = 16;
+		std::vector<Vector2f> centers;
+		for (size_t i = 0; i < cClusterCount; i++)
+		{
+			centers.emplace_back(unit(gen) * 0.8f, unit(gen) * 0.8f);
+		}
+		std::normal_distribution<float> spread(0.0f, 0.02f);
+		for (size_t i = 0; i < count; i++)
+		{
+			const Vector2f& c = centers[i % cClusterCount];
+			outPoints.emplace_back(c.x + spread(gen), c.y + spread(gen));
+		}
+	}
+	else if (distribution == "circular")
+	{
+		// Every point on the hull, nearly cocircular for Delaunay
+		std::uniform_real_distribution<float> angle(0.0f, 6.28318531f);
+		for (size_t i = 0; i < count; i++)
+		{
+			float a = angle(gen);
+			outPoints.emplace_back(std::cos(a), std::sin(a));
+		}
+	}
+	else if (distribution == "collinear")
+	{
+		// Exactly collinear, y == x
+		for (size_t i = 0; i < count; i++)
+		{
+			float t = unit(gen);
+			outPoints.emplace_back(t, t);
+		}
+	}
+	else if (distribution == "grid")
+	{
+		// Shuffled lattice, maximal cocircular degeneracy
+		size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+		float step = side > 1 ? 2.0f / (side - 1) : 0.0f;
+		for (size_t i = 0; i < count; i++)
+		{
+			outPoints.emplace_back(-1.0f + step * (i % side), -1.0f + step * (i / side));
+		}
+		std::shuffle(outPoints.begin(), outPoints.end(), gen);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+float boundingArea(const std::vector<Vector2f>& points)
+{
+	float minX = std::numeric_limits<float>::max(), maxX = -minX;
+	float minY = minX, maxY = maxX;
+	for (const Vector2f& p : points)
+	{
+		minX = std::min(minX, p.x);
+		maxX = std::max(maxX, p.x);
+		minY = std::min(minY, p.y);
+		maxY = std::max(maxY, p.y);
+	}
+	return (maxX - minX) * (maxY - minY);
+}
+
+// Simple polygon through points [first, last), ordered by angle around the bounding box center
+void makeStarPolygon(std::vector<Vector2f>& points, size_t first, size_t last)
+{
+	Vector2f minP = points[first];
+	Vector2f maxP = minP;
+	for (size_t i = first; i < last; i++)
+	{
+		const Vector2f& p = points[i];
+		minP.x = std::min(minP.x, p.x);
+		minP.y = std::min(minP.y, p.y);
+		maxP.x = std::max(maxP.x, p.x);
+		maxP.y = std::max(maxP.y, p.y);
+	}
+	const Vector2f center = (minP + maxP) * 0.5f;
+	std::sort(points.begin() + first, points.begin() + last, [&](const Vector2f& a, const Vector2f& b)
+	{
+		float angleA = std::atan2(a.y - center.y, a.x - center.x);
+		float angleB = std::atan2(b.y - center.y, b.x - center.x);
+		if (angleA != angleB)
+		{
+			return angleA < angleB;
+		}
+		return (a - center).lengthSquared() < (b - center).lengthSquared();
+	});
+}
+
+// Road like polylines through all points that never cross, the points are cut into
+// horizontal strips of about sqrt(n) points and each strip is joined from left to right
+void makeStripSegments(const std::vector<Vector2f>& points, std::vector<std::pair<size_t, size_t>>& segments)
+{
+	std::vector<size_t> ids(points.size());
+	std::iota(ids.begin(), ids.end(), size_t(0));
+	auto byY = [&](size_t a, size_t b)
+	{
+		return points[a].y < points[b].y || (points[a].y == points[b].y && points[a].x < points[b].x);
+	};
+	auto byX = [&](size_t a, size_t b)
+	{
+		return points[a].x < points[b].x || (points[a].x == points[b].x && points[a].y < points[b].y);
+	};
+	std::sort(ids.begin(), ids.end(), byY);
+
+	const size_t stripSize = std::max<size_t>(2, static_cast<size_t>(std::sqrt(double(points.size()))));
+	segments.clear();
+	for (size_t first = 0; first < ids.size(); first += stripSize)
+	{
+		const size_t last = std::min(first + stripSize, ids.size());
+		std::sort(ids.begin() + first, ids.begin() + last, byX);
+		for (size_t i = first + 1; i < last; i++)
+		{
+			segments.emplace_back(ids[i - 1], ids[i]);
+		}
+	}
+}
+
+class Reporter
+{
+public:
+	Reporter(const std::string& algorithm, const std::string& distribution,
+			 size_t pointCount, size_t threadCount, size_t repeat)
+		: mAlgorithm(algorithm)
+		, mDistribution(distribution)
+		, mPointCount(pointCount)
+		, mThreadCount(threadCount)
+		, mRepeat(repeat)
+		, mStart(std::chrono::steady_clock::now())
+	{
+	}
+
+	// Report the time since the previous phase ended
+	void phase(const std::string& name, size_t outputSize)
+	{
+		auto now = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(now - mStart).count();
+		double mpts = ms > 0 ? mPointCount / (ms * 1000.0) : 0.0;
+		std::printf("%s,%s,%zu,%zu,%zu,%s,%.3f,%.3f,%zu,%zu\n",
+					mAlgorithm.c_str(), mDistribution.c_str(), mPointCount, mThreadCount, mRepeat,
+					name.c_str(), ms, mpts, outputSize, peakRssKb());
+		std::fflush(stdout);
+		mStart = std::chrono::steady_clock::now();
+	}
+
+private:
+	std::string mAlgorithm;
+	std::string mDistribution;
+	size_t mPointCount;
+	size_t mThreadCount;
+	size_t mRepeat;
+	std::chrono::steady_clock::time_point mStart;
+};
+
+bool runAlgorithm(const std::string& algorithm, std::vector<Vector2f>& points,
+				  size_t threadCount, Reporter& reporter)
+{
+	std::vector<uint32_t> indices;
+	if (algorithm == "hull" || algorithm == "hull-cull"
+		|| algorithm == "hull-chain" || algorithm == "hull-chain-cull"
+		|| algorithm == "hull-chan" || algorithm == "hull-chan-cull")
+	{
+		ConvexHull::Algorithm hullAlgorithm = ConvexHull::Algorithm::GrahamScan;
+		if (algorithm.find("chain") != std::string::npos)
+		{
+			hullAlgorithm = ConvexHull::Algorithm::MonotoneChain;
+		}
+		else if (algorithm.find("chan") != std::string::npos)
+		{
+			hullAlgorithm = ConvexHull::Algorithm::Chan;
+		}
+		bool cull = algorithm.find("cull") != std::string::npos;
+		ConvexHull hull(points,
+						hullAlgorithm,
+						cull ? ConvexHull::Culling::AklToussaint : ConvexHull::Culling::None,
+						threadCount);
+		reporter.phase("sort", 0);
+		hull.process();
+		reporter.phase("scan", 0);
+		hull.extractLineSegmentIndices(indices);
+		reporter.phase("extract", indices.size());
+	}
+	else if (algorithm == "hull-incremental")
+	{
+		IncrementalConvexHull hull;
+		hull.insert(points);
+		reporter.phase("insert", 0);
+		hull.extractLineSegmentIndices(indices);
+		reporter.phase("extract", indices.size());
+	}
+	else if (algorithm == "delaunay" || algorithm == "delaunay-brio")
+	{
+		bool brio = algorithm == "delaunay-brio";
+		DelaunayTriangulation dt(points,
+								 brio ? DelaunayTriangulation::InsertionOrder::BiasedRandomized
+									  : DelaunayTriangulation::InsertionOrder::Input,
+								 brio ? DelaunayTriangulation::PointLocation::Walk
+									  : DelaunayTriangulation::PointLocation::Bucketing);
+		reporter.phase("triangulate", 0);
+		dt.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+	}
+	else if (algorithm == "delaunay-compact")
+	{
+		// 32-bit mesh, an empty triangulation past its point limit
+		CompactDelaunayTriangulation dt(points);
+		reporter.phase("triangulate", 0);
+		dt.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+	}
+	else if (algorithm == "delaunay-cdt")
+	{
+		std::vector<std::pair<size_t, size_t>> segments;
+		makeStripSegments(points, segments);
+		reporter.phase("segments", segments.size());
+		DelaunayTriangulation dt(points);
+		reporter.phase("triangulate", 0);
+		size_t inserted = 0;
+		for (const auto& segment : segments)
+		{
+			inserted += dt.insertConstraint(segment.first, segment.second) ? 1 : 0;
+		}
+		reporter.phase("constrain", inserted);
+		dt.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+	}
+	else if (algorithm == "delaunay-refine")
+	{
+		// 20 degrees and about as many triangles again as points by area,
+		// capped in case the distribution has sharp hull corners
+		const float maxArea = boundingArea(points) / points.size();
+		const size_t maxPointCount = 10 * points.size();
+		DelaunayTriangulation dt(points);
+		reporter.phase("triangulate", 0);
+		const size_t added = dt.refine(20.0f, maxArea, maxPointCount);
+		reporter.phase("refine", added);
+		dt.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+	}
+	else if (algorithm == "delaunay-dynamic")
+	{
+		// Ten frames each move a tenth of the points by up to a quarter of the mean spacing,
+		// then a tenth is removed, against triangulating the final points from scratch
+		const size_t count = points.size();
+		const float jitter = 0.25f * std::sqrt(boundingArea(points) / count);
+		std::minstd_rand gen(static_cast<uint32_t>(count));
+		std::uniform_real_distribution<float> offset(-jitter, jitter);
+		DelaunayTriangulation dt(points);
+		reporter.phase("triangulate", 0);
+		size_t moved = 0;
+		for (size_t frame = 0; frame < 10; frame++)
+		{
+			for (size_t i = frame; i < count; i += 10)
+			{
+				const Vector2f p = dt.points()[i];
+				moved += dt.movePoint(i, Vector2f(p.x + offset(gen), p.y + offset(gen))) ? 1 : 0;
+			}
+		}
+		reporter.phase("move", moved);
+		size_t removed = 0;
+		for (size_t i = 5; i < count; i += 10)
+		{
+			removed += dt.removePoint(i) ? 1 : 0;
+		}
+		reporter.phase("remove", removed);
+		dt.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+
+		std::vector<Vector2f> remaining;
+		remaining.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i % 10 != 5)
+			{
+				remaining.push_back(dt.points()[i]);
+			}
+		}
+		DelaunayTriangulation rebuilt(remaining);
+		reporter.phase("rebuild", 0);
+	}
+	else if (algorithm == "delaunay-dc")
+	{
+		ParallelDelaunayTriangulation dt(points, threadCount);
+		reporter.phase("triangulate", 0);
+		dt.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+	}
+	else if (algorithm == "polygon")
+	{
+		makeStarPolygon(points, 0, points.size());
+		reporter.phase("order", 0);
+		PolygonTriangulation triangulation(points);
+		reporter.phase("triangulate", 0);
+		triangulation.extractTriangleIndices(indices);
+		reporter.phase("extract", indices.size() / 3);
+	}
+	else if (algorithm == "polygon-batch")
+	{
+		// Footprint sized polygons of consecutive points, one ring each
+		const size_t polygonSize = 16;
+		std::vector<size_t> ringOffsets;
+		for (size_t first = 0; first < points.size(); first += polygonSize)
+		{
+			ringOffsets.push_back(first);
+			makeStarPolygon(points, first, std::min(first + polygonSize, points.size()));
+		}
+		std::vector<size_t> polygonOffsets(ringOffsets.size());
+		std::iota(polygonOffsets.begin(), polygonOffsets.end(), size_t(0));
+		reporter.phase("order", 0);
+		std::vector<size_t> indexOffsets;
+		PolygonTriangulation::triangulateBatch(points, ringOffsets, polygonOffsets, indices, indexOffsets,
+											   PolygonTriangulation::Algorithm::Auto, threadCount);
+		reporter.phase("triangulate", indices.size() / 3);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> algorithms{ "hull", "hull-cull", "hull-chain", "hull-chain-cull",
+										 "hull-chan", "hull-chan-cull", "hull-incremental",
+										 "delaunay", "delaunay-brio", "delaunay-compact", "delaunay-dc",
+										 "delaunay-cdt", "delaunay-refine", "delaunay-dynamic",
+										 "polygon", "polygon-batch" };
+	std::vector<std::string> distributions{ "uniform", "clustered", "circular", "collinear", "grid" };
+	std::vector<size_t> sizes{ 1000, 10000, 100000, 1000000 };
+	size_t repeatCount = 1;
+	size_t threadCount = 0;
+	uint32_t seed = 0;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string option = argv[i];
+		std::string value = argv[i + 1];
+		if (option == "--algorithms")
+		{
+			algorithms = splitList(value);
+		}
+		else if (option == "--distributions")
+		{
+			distributions = splitList(value);
+		}
+		else if (option == "--sizes")
+		{
+			sizes.clear();
+			for (const std::string& size : splitList(value))
+			{
+				sizes.push_back(static_cast<size_t>(std::stod(size)));
+			}
+		}
+		else if (option == "--repeat")
+		{
+			repeatCount = std::stoul(value);
+		}
+		else if (option == "--threads")
+		{
+			threadCount = std::stoul(value);
+		}
+		else if (option == "--seed")
+		{
+			seed = static_cast<uint32_t>(std::stoul(value));
+		}
+		else
+		{
+			std::cerr << "Unknown option " << option << std::endl;
+			return 1;
+		}
+	}
+
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	std::printf("algorithm,distribution,points,threads,repeat,phase,ms,mpts_per_s,output_size,peak_rss_kb\n");
+
+	std::vector<Vector2f> input;
+	std::vector<Vector2f> points;
+	for (const std::string& distribution : distributions)
+	{
+		for (size_t size : sizes)
+		{
+			if (!generatePoints(distribution, size, seed, input))
+			{
+				std::cerr << "Unknown distribution " << distribution << std::endl;
+				return 1;
+			}
+			for (const std::string& algorithm : algorithms)
+			{
+				for (size_t repeat = 0; repeat < repeatCount; repeat++)
+				{
+					// Algorithms take over their input
+					points = input;
+					Reporter reporter(algorithm, distribution, size, threadCount, repeat);
+					if (!runAlgorithm(algorithm, points, threadCount, reporter))
+					{
+						std::cerr << "Unknown algorithm " << algorithm << std::endl;
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	return 0;
+}
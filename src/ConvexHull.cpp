@@ -1,9 +1,71 @@
 #include "ConvexHull.h"
 
-ConvexHull::ConvexHull(std::vector<Vector2f> &points)
+namespace
+{
+
+// Chunks smaller than this are not worth a thread
+const size_t cMinChunkSize = 1 << 16;
+
+const size_t cNoVertex = static_cast<size_t>(-1);
+// Chan's algorithm squares the group size per round, starting from 2^(2^3)
+// Smaller first rounds only rebuild groups for hulls this small anyway
+const size_t cInitialGroupSize = 256;
+// Group hulls up to this size are searched linearly for tangents
+const size_t cLinearTangentSize = 8;
+
+// a and b lie on the same ray from p
+bool fartherOnRay(const Vector2f& p, const Vector2f& a, const Vector2f& b)
+{
+	if (a.x != b.x)
+	{
+		return (a.x > b.x) == (a.x > p.x);
+	}
+	return (a.y > b.y) == (a.y > p.y);
+}
+
+// Gift wrapping order seen from hull vertex p: a comes before b if b is left of p->a,
+// farther on the same ray, or the same point with a smaller id
+// Points equal to p come last
+bool wrapsBefore(const Vector2f& p, const Vector2f& a, size_t idA, const Vector2f& b, size_t idB)
+{
+	if (a == p)
+	{
+		return false;
+	}
+	if (b == p)
+	{
+		return true;
+	}
+	const double side = Predicates::orient2d(p, a, b);
+	if (side != 0)
+	{
+		return side > 0;
+	}
+	if (a == b)
+	{
+		return idA < idB;
+	}
+	return fartherOnRay(p, a, b);
+}
+
+}
+
+ConvexHull::ConvexHull(PointSet &&points, Algorithm algorithm, Culling culling, size_t threadCount)
 	: mPoints(std::move(points))
-	, mHullIndices(mPoints.size(), 0)
+	, mAlgorithm(algorithm)
+	, mCulling(culling)
+	, mThreadCount(threadCount)
+	, mStackTop(0)
+	, mProcessPos(0)
+	, mChainFloor(1)
+	, mGroupSize(0)
+	, mStartVertex(0)
+	, mCurrentVertex(0)
 {
+	if (mThreadCount == 0)
+	{
+		mThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
 	if (!mPoints.empty())
 	{
 
@@ -11,6 +73,16 @@ ConvexHull::ConvexHull(std::vector<Vector2f> &points)
 	}
 }
 
+ConvexHull::ConvexHull(std::vector<Vector2f> &points, Algorithm algorithm, Culling culling, size_t threadCount)
+	: ConvexHull(PointSet(points), algorithm, culling, threadCount)
+{
+}
+
+ConvexHull::ConvexHull(Vector2SoA &points, Algorithm algorithm, Culling culling, size_t threadCount)
+	: ConvexHull(PointSet(points), algorithm, culling, threadCount)
+{
+}
+
 ConvexHull::~ConvexHull()
 {
 }
@@ -26,69 +98,385 @@ void ConvexHull::extractLineSegmentIndices(std::vector<uint32_t> &indices) const
 	indices.resize(mStackTop + 1);
 	for (size_t i = 0; i <= mStackTop; i++)
 	{
-		indices[i] = static_cast<uint32_t>(mHullIndices[i]);
+		const size_t id = mAlgorithm == Algorithm::MonotoneChain
+			? mChainPoints[mHullIndices[i]].id
+			: mHullIndices[i];
+		indices[i] = static_cast<uint32_t>(id);
 	}
 }
 
 void ConvexHull::findBottomPoint()
 {
-	const Vector2f* minP = &mPoints.front();
+	size_t bottomPos = 0;
+	Vector2f minP = mPoints[mHullIndices[0]];
 
-	for (size_t i = 1; i < mPoints.size(); i++)
+	for (size_t i = 1; i < mHullIndices.size(); i++)
 	{
-		if ((mPoints[i].y == minP->y && mPoints[i].x < minP->x)
-			|| (mPoints[i].y < minP->y))
+		const Vector2f p = mPoints[mHullIndices[i]];
+		if ((p.y == minP.y && p.x < minP.x)
+			|| (p.y < minP.y))
 		{
-			minP = &mPoints[i];
-			mHullIndices[0] = i;
+			minP = p;
+			bottomPos = i;
 		}
 	}
+	std::swap(mHullIndices[0], mHullIndices[bottomPos]);
 }
 
 void ConvexHull::initIndices()
 {
-	for (size_t i = 0, idx = 1; i < mPoints.size(); i++)
+	mHullIndices.resize(mPoints.size());
+	std::iota(mHullIndices.begin(), mHullIndices.end(), 0);
+}
+
+void ConvexHull::cullInteriorPoints(size_t first, size_t last, std::vector<size_t>& outIds) const
+{
+	// Extremes in x, y, x+y and x-y, all found in one pass
+	// Sums of two floats are exact in double
+	enum { Bottom, BottomRight, Right, TopRight, Top, TopLeft, Left, BottomLeft, ExtremeCount };
+	size_t extremes[ExtremeCount];
+	double values[ExtremeCount];
+	std::fill(extremes, extremes + ExtremeCount, first);
+	{
+		const Vector2f p = mPoints[first];
+		values[Bottom] = p.y;
+		values[BottomRight] = double(p.x) - p.y;
+		values[Right] = p.x;
+		values[TopRight] = double(p.x) + p.y;
+		values[Top] = p.y;
+		values[TopLeft] = double(p.x) - p.y;
+		values[Left] = p.x;
+		values[BottomLeft] = double(p.x) + p.y;
+	}
+	for (size_t i = first + 1; i < last; i++)
+	{
+		const double x = mPoints.x(i);
+		const double y = mPoints.y(i);
+		const double sum = x + y;
+		const double diff = x - y;
+		if (y < values[Bottom]) { values[Bottom] = y; extremes[Bottom] = i; }
+		if (diff > values[BottomRight]) { values[BottomRight] = diff; extremes[BottomRight] = i; }
+		if (x > values[Right]) { values[Right] = x; extremes[Right] = i; }
+		if (sum > values[TopRight]) { values[TopRight] = sum; extremes[TopRight] = i; }
+		if (y > values[Top]) { values[Top] = y; extremes[Top] = i; }
+		if (diff < values[TopLeft]) { values[TopLeft] = diff; extremes[TopLeft] = i; }
+		if (x < values[Left]) { values[Left] = x; extremes[Left] = i; }
+		if (sum < values[BottomLeft]) { values[BottomLeft] = sum; extremes[BottomLeft] = i; }
+	}
+
+	// Counter-clockwise octagon, extremes shared by neighbours collapse
+	Vector2f octagon[ExtremeCount];
+	size_t octagonSize = 0;
+	for (size_t i = 0; i < ExtremeCount; i++)
 	{
-		if (i != mHullIndices.front())
+		const Vector2f p = mPoints[extremes[i]];
+		if (octagonSize == 0 || !(p == octagon[octagonSize - 1]))
 		{
-			mHullIndices[idx++] = i;
+			octagon[octagonSize++] = p;
+		}
+	}
+	while (octagonSize > 1 && octagon[octagonSize - 1] == octagon[0])
+	{
+		octagonSize--;
+	}
+
+	outIds.clear();
+	if (octagonSize < 3)
+	{
+		outIds.resize(last - first);
+		std::iota(outIds.begin(), outIds.end(), first);
+		return;
+	}
+
+	// Strictly interior points are neither hull vertices nor on a hull edge,
+	// so the resulting hull is the same as without culling
+	for (size_t i = first; i < last; i++)
+	{
+		const Vector2f p = mPoints[i];
+		bool inside = true;
+		for (size_t j = 0; j < octagonSize && inside; j++)
+		{
+			const size_t k = j + 1 < octagonSize ? j + 1 : 0;
+			inside = Predicates::orient2d(octagon[j], octagon[k], p) > 0;
+		}
+		if (!inside)
+		{
+			outIds.push_back(i);
 		}
 	}
-	mStackTop = 1;
-	mProcessPos = 2;
 }
 
 void ConvexHull::sort()
 {
-	std::sort(mHullIndices.begin() + 1, mHullIndices.end(),
-			  [&](size_t i, size_t j) -> bool
+	const Vector2f origin = mPoints[mHullIndices[0]];
+	// Counter-clockwise around the bottom point, the closer of two collinear points first
+	// Copies of the bottom point have no angle and come before all others,
+	// so the order stays strict weak
+	// Copies of a point go from the largest id down and the scan keeps the last of them,
+	// so each hull point is reported by its smallest id, as with MonotoneChain,
+	// whichever candidates culling or threads left
+	auto polarLess = [&](size_t i, size_t j) -> bool
+	{
+		const Vector2f pi = mPoints[i];
+		const Vector2f pj = mPoints[j];
+		if (pi == pj)
+		{
+			return i > j;
+		}
+		if (pi == origin || pj == origin)
+		{
+			return pi == origin && pj != origin;
+		}
+		double res = Predicates::orient2d(origin, pi, pj);
+		if (res != 0)
+		{
+			return res > 0;
+		}
+		const double xi = double(pi.x) - origin.x, yi = double(pi.y) - origin.y;
+		const double xj = double(pj.x) - origin.x, yj = double(pj.y) - origin.y;
+		return xi * xi + yi * yi < xj * xj + yj * yj;
+	};
+
+	// Pseudo-angle keys, monotone in the angle over [0, pi] as every point
+	// lies on or above the bottom point, sorted without any comparisons
+	const size_t count = mHullIndices.size() - 1;
+	std::vector<Utils::KeyedId<uint32_t>> keys(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const size_t id = mHullIndices[i + 1];
+		const Vector2f p = mPoints[id];
+		const double dx = double(p.x) - origin.x;
+		const double dy = double(p.y) - origin.y;
+		const double sum = std::abs(dx) + dy;
+		const float angle = sum > 0 ? static_cast<float>(1.0 - dx / sum) : 0.0f;
+		keys[i].key = Utils::sortableBits(angle);
+		keys[i].id = id;
+	}
+	Utils::radixSort(keys, mThreadCount);
+
+	// Equal keys only mean nearly equal angles, each run of them is ordered exactly
+	size_t runStart = 0;
+	for (size_t i = 0; i <= count; i++)
 	{
-		const Vector2f v0 = mPoints[i] - mPoints[mHullIndices[0]];
-		const Vector2f v1 = mPoints[j] - mPoints[mHullIndices[0]];
-		float res = cross(v0, v1);
-		if (res > 0)
+		if (i < count)
 		{
-			return true;
+			mHullIndices[i + 1] = keys[i].id;
+			if (keys[i].key == keys[runStart].key)
+			{
+				continue;
+			}
 		}
-		else if (res < 0)
+		if (i - runStart > 1)
 		{
-			return false;
+			std::sort(mHullIndices.begin() + 1 + runStart, mHullIndices.begin() + 1 + i, polarLess);
+		}
+		runStart = i;
+	}
+
+	// Rounding may still swap nearly equal angles across runs, an insertion pass
+	// fixes those few inversions and hands over to a full sort if there are many
+	const size_t maxMoves = 4 * count;
+	size_t moves = 0;
+	for (size_t i = 2; i <= count && moves <= maxMoves; i++)
+	{
+		const size_t id = mHullIndices[i];
+		size_t j = i;
+		for (; j > 1 && polarLess(id, mHullIndices[j - 1]); j--)
+		{
+			mHullIndices[j] = mHullIndices[j - 1];
+			moves++;
+		}
+		mHullIndices[j] = id;
+	}
+	if (moves > maxMoves)
+	{
+		std::sort(mHullIndices.begin() + 1, mHullIndices.end(), polarLess);
+	}
+}
+
+void ConvexHull::makeChainPoints(const size_t* ids, size_t count, std::vector<ChainPoint>& outPoints,
+								 size_t threadCount) const
+{
+	outPoints.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const size_t id = ids[i];
+		outPoints[i].key = Utils::lexicographicKey(mPoints[id]);
+		outPoints[i].id = id;
+	}
+	sortChainPoints(outPoints, threadCount);
+}
+
+void ConvexHull::sortChainPoints(std::vector<ChainPoint>& points, size_t threadCount)
+{
+	Utils::radixSort(points, threadCount);
+	// Of duplicated points only the smallest id is kept,
+	// so the result does not depend on how candidates were gathered
+	size_t last = 0;
+	for (size_t i = 1; i < points.size(); i++)
+	{
+		if (points[i].key != points[last].key)
+		{
+			points[++last] = points[i];
+		}
+		else if (points[i].id < points[last].id)
+		{
+			points[last].id = points[i].id;
+		}
+	}
+	points.resize(std::min<size_t>(points.size(), last + 1));
+}
+
+void ConvexHull::chainCorners(const std::vector<ChainPoint>& points, std::vector<size_t>& outIds)
+{
+	outIds.clear();
+	const size_t count = points.size();
+	if (count < 3)
+	{
+		for (const ChainPoint& cp : points)
+		{
+			outIds.push_back(cp.id);
+		}
+		return;
+	}
+
+	// outIds holds the stack of sorted positions, lower hull then upper hull,
+	// and is turned into ids at the end
+	std::vector<size_t>& stack = outIds;
+	auto turnsLeft = [&](size_t pos)
+	{
+		return Predicates::orient2d(Utils::fromLexicographicKey(points[stack[stack.size() - 2]].key),
+									Utils::fromLexicographicKey(points[stack.back()].key),
+									Utils::fromLexicographicKey(points[pos].key)) > 0;
+	};
+	for (size_t i = 0; i < count; i++)
+	{
+		while (stack.size() >= 2 && !turnsLeft(i))
+		{
+			stack.pop_back();
+		}
+		stack.push_back(i);
+	}
+	const size_t lowerSize = stack.size();
+	for (size_t i = count - 1; i-- > 0;)
+	{
+		while (stack.size() > lowerSize && !turnsLeft(i))
+		{
+			stack.pop_back();
+		}
+		stack.push_back(i);
+	}
+	// Closing point is the first one
+	stack.pop_back();
+
+	for (size_t& pos : stack)
+	{
+		pos = points[pos].id;
+	}
+}
+
+void ConvexHull::findCandidates()
+{
+	// Chunks may drop collinear boundary points unless Graham scan has to report them
+	const bool chain = mAlgorithm != Algorithm::GrahamScan;
+	const bool cull = mCulling == Culling::AklToussaint;
+	const size_t pointCount = mPoints.size();
+
+	// Only the reduction of candidates runs in parallel,
+	// Graham scan without culling has nothing to reduce
+	size_t chunkCount = std::min(mThreadCount, std::max<size_t>(pointCount / cMinChunkSize, 1));
+	if (!chain && !cull)
+	{
+		chunkCount = 1;
+	}
+
+	if (chunkCount == 1)
+	{
+		if (cull)
+		{
+			cullInteriorPoints(0, pointCount, mHullIndices);
+		}
+		else
+		{
+			initIndices();
+		}
+		return;
+	}
+
+	// Any point not kept by its chunk is not on the hull of the chunk,
+	// so it is not on the hull of all points either
+	std::vector<std::vector<size_t>> chunkIds(chunkCount);
+	auto reduceChunk = [&](size_t chunk)
+	{
+		const size_t first = pointCount * chunk / chunkCount;
+		const size_t last = pointCount * (chunk + 1) / chunkCount;
+		std::vector<size_t>& ids = chunkIds[chunk];
+		if (cull)
+		{
+			cullInteriorPoints(first, last, ids);
 		}
-		// Res == 0
 		else
 		{
-			return v1.lengthSquared() > v0.lengthSquared();
+			ids.resize(last - first);
+			std::iota(ids.begin(), ids.end(), first);
+		}
+		if (chain)
+		{
+			std::vector<ChainPoint> points;
+			makeChainPoints(ids.data(), ids.size(), points);
+			chainCorners(points, ids);
 		}
-	});
+	};
+
+	std::vector<std::future<void>> tasks;
+	for (size_t chunk = 1; chunk < chunkCount; chunk++)
+	{
+		tasks.push_back(std::async(std::launch::async, reduceChunk, chunk));
+	}
+	reduceChunk(0);
+	for (auto& task : tasks)
+	{
+		task.get();
+	}
+
+	mHullIndices.clear();
+	for (const std::vector<size_t>& ids : chunkIds)
+	{
+		mHullIndices.insert(mHullIndices.end(), ids.begin(), ids.end());
+	}
 }
 
 void ConvexHull::preprocess()
 {
-	findBottomPoint();
+	findCandidates();
 
-	initIndices();
+	if (mAlgorithm == Algorithm::MonotoneChain)
+	{
+		makeChainPoints(mHullIndices.data(), mHullIndices.size(), mChainPoints, mThreadCount);
+
+		// Stack starts with the leftmost point, mHullIndices is reused as the stack
+		// and holds sorted positions, which keeps the scan within mChainPoints
+		mHullIndices[0] = 0;
+		mStackTop = 0;
+		mProcessPos = 1;
+		mChainFloor = 1;
+		return;
+	}
+
+	if (mAlgorithm == Algorithm::Chan)
+	{
+		mCandidates.swap(mHullIndices);
+		mGroupSize = std::min(cInitialGroupSize, mCandidates.size());
+		buildGroupHulls();
+		return;
+	}
+
+	findBottomPoint();
 
 	sort();
+
+	mStackTop = 1;
+	mProcessPos = 2;
 }
 
 void ConvexHull::process()
@@ -100,7 +488,20 @@ void ConvexHull::process()
 
 bool ConvexHull::advance()
 {
-	if (mProcessPos >= mPoints.size())
+	switch (mAlgorithm)
+	{
+	case Algorithm::MonotoneChain:
+		return advanceMonotoneChain();
+	case Algorithm::Chan:
+		return advanceChan();
+	default:
+		return advanceGrahamScan();
+	}
+}
+
+bool ConvexHull::advanceGrahamScan()
+{
+	if (mProcessPos >= mHullIndices.size())
 	{
 		return false;
 	}
@@ -111,10 +512,265 @@ bool ConvexHull::advance()
 	{
 		mHullIndices[++mStackTop] = mHullIndices[mProcessPos++];
 	}
+	else if (mStackTop > 1)
+	{
+		mStackTop--;
+	}
 	else
+	{
+		// Sorted by angle, only a copy of the point above the bottom one fails here,
+		// the later copy takes its place as it does further up the stack
+		mHullIndices[mStackTop] = mHullIndices[mProcessPos++];
+	}
+
+	return true;
+}
+
+Vector2f ConvexHull::chainPoint(size_t pos) const
+{
+	return Utils::fromLexicographicKey(mChainPoints[pos].key);
+}
+
+bool ConvexHull::advanceMonotoneChain()
+{
+	// Lower hull visits sorted positions 0 to count - 1,
+	// upper hull walks back from count - 2 and closes at 0
+	const size_t count = mChainPoints.size();
+	if (count < 2 || mProcessPos >= 2 * count - 1)
+	{
+		return false;
+	}
+
+	const size_t pos = mProcessPos < count ? mProcessPos : 2 * count - 2 - mProcessPos;
+
+	if (mStackTop >= mChainFloor
+		&& Predicates::orient2d(chainPoint(mHullIndices[mStackTop - 1]),
+								chainPoint(mHullIndices[mStackTop]),
+								chainPoint(pos)) <= 0)
 	{
 		mStackTop--;
 	}
+	else
+	{
+		// The leftmost point is already at the bottom of the stack
+		if (mProcessPos != 2 * count - 2)
+		{
+			// A lower hull point can sit on the upper chain until the next turn,
+			// so the stack may briefly hold one entry more than there are candidates
+			if (++mStackTop == mHullIndices.size())
+			{
+				mHullIndices.push_back(pos);
+			}
+			else
+			{
+				mHullIndices[mStackTop] = pos;
+			}
+		}
+		if (++mProcessPos == count)
+		{
+			mChainFloor = mStackTop + 1;
+		}
+	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+void ConvexHull::buildGroupHulls()
+{
+	mGroupVertices.clear();
+	mGroupVertexIds.clear();
+	mGroupOffsets.assign(1, 0);
+
+	std::vector<ChainPoint> points;
+	std::vector<size_t> corners;
+	for (size_t first = 0; first < mCandidates.size(); first += mGroupSize)
+	{
+		const size_t count = std::min(mGroupSize, mCandidates.size() - first);
+		makeChainPoints(&mCandidates[first], count, points);
+		chainCorners(points, corners);
+		for (size_t id : corners)
+		{
+			mGroupVertices.push_back(mPoints[id]);
+			mGroupVertexIds.push_back(id);
+		}
+		mGroupOffsets.push_back(mGroupVertices.size());
+	}
+
+	// The lexicographically smallest point, smallest id among its duplicates, is a hull corner
+	mStartVertex = 0;
+	for (size_t i = 1; i < mGroupVertices.size(); i++)
+	{
+		const Vector2f& p = mGroupVertices[i];
+		const Vector2f& start = mGroupVertices[mStartVertex];
+		if (p.x < start.x || (p.x == start.x && p.y < start.y)
+			|| (p == start && mGroupVertexIds[i] < mGroupVertexIds[mStartVertex]))
+		{
+			mStartVertex = i;
+		}
+	}
+
+	mCurrentVertex = mStartVertex;
+	mHullIndices.assign(1, mGroupVertexIds[mStartVertex]);
+	mStackTop = 0;
+	mProcessPos = 0;
+}
+
+size_t ConvexHull::groupTangent(size_t group, const Vector2f& p) const
+{
+	const size_t first = mGroupOffsets[group];
+	const size_t count = mGroupOffsets[group + 1] - first;
+	const Vector2f* v = &mGroupVertices[first];
+	const size_t* ids = &mGroupVertexIds[first];
+	auto before = [&](size_t a, size_t b)
+	{
+		return wrapsBefore(p, v[a], ids[a], v[b], ids[b]);
+	};
+	auto linearSearch = [&]()
+	{
+		size_t best = 0;
+		for (size_t i = 1; i < count; i++)
+		{
+			if (before(i, best))
+			{
+				best = i;
+			}
+		}
+		return v[best] == p ? cNoVertex : first + best;
+	};
+
+	if (count <= cLinearTangentSize)
+	{
+		return linearSearch();
+	}
+
+	// Binary search for the tangent of a convex polygon after Dan Sunday,
+	// an edge goes up when its end comes before its start in wrapping order
+	auto at = [&](size_t i) { return i % count; };
+	size_t tangent = cNoVertex;
+	if (before(0, 1) && !before(at(count - 1), 0))
+	{
+		tangent = 0;
+	}
+	for (size_t a = 0, b = count, iteration = 0; tangent == cNoVertex && iteration < 64; iteration++)
+	{
+		const size_t c = (a + b) / 2;
+		const bool downC = before(c, at(c + 1));
+		if (downC && !before(c - 1, c))
+		{
+			tangent = c;
+			break;
+		}
+		const bool upA = before(at(a + 1), a);
+		if (upA)
+		{
+			if (downC || before(a, c))
+			{
+				b = c;
+			}
+			else
+			{
+				a = c;
+			}
+		}
+		else
+		{
+			if (!downC || !before(c, a))
+			{
+				a = c;
+			}
+			else
+			{
+				b = c;
+			}
+		}
+		if (b - a < 2)
+		{
+			break;
+		}
+	}
+	if (tangent == cNoVertex)
+	{
+		return linearSearch();
+	}
+
+	// The search is only a guess in degenerate cases, walk to the local optimum,
+	// which on a convex polygon is the global one unless it is p itself
+	for (size_t step = 0; step < count; step++)
+	{
+		const size_t next = at(tangent + 1);
+		const size_t prev = at(tangent + count - 1);
+		if (before(next, tangent))
+		{
+			tangent = next;
+		}
+		else if (before(prev, tangent))
+		{
+			tangent = prev;
+		}
+		else
+		{
+			return v[tangent] == p ? linearSearch() : first + tangent;
+		}
+	}
+	return linearSearch();
+}
+
+bool ConvexHull::advanceChan()
+{
+	if (mProcessPos != 0)
+	{
+		return false;
+	}
+
+	const Vector2f p = mGroupVertices[mCurrentVertex];
+	const size_t currentGroup = std::upper_bound(mGroupOffsets.begin(), mGroupOffsets.end(), mCurrentVertex)
+		- mGroupOffsets.begin() - 1;
+
+	// Successor within its own group, tangents of all other groups
+	size_t best = cNoVertex;
+	{
+		const size_t first = mGroupOffsets[currentGroup];
+		const size_t count = mGroupOffsets[currentGroup + 1] - first;
+		if (count > 1)
+		{
+			best = first + (mCurrentVertex - first + 1) % count;
+		}
+	}
+	for (size_t group = 0; group + 1 < mGroupOffsets.size(); group++)
+	{
+		if (group == currentGroup)
+		{
+			continue;
+		}
+		const size_t tangent = groupTangent(group, p);
+		if (tangent != cNoVertex
+			&& (best == cNoVertex
+				|| wrapsBefore(p, mGroupVertices[tangent], mGroupVertexIds[tangent],
+							   mGroupVertices[best], mGroupVertexIds[best])))
+		{
+			best = tangent;
+		}
+	}
+
+	if (best == cNoVertex || mGroupVertices[best] == mGroupVertices[mStartVertex])
+	{
+		// Wrapped around
+		mProcessPos = 1;
+		return true;
+	}
+
+	if (mStackTop + 1 >= mGroupSize && mGroupSize < mCandidates.size())
+	{
+		// More than mGroupSize hull vertices, the guess was too small
+		mGroupSize = mGroupSize > (size_t(1) << 31)
+			? mCandidates.size()
+			: std::min(mGroupSize * mGroupSize, mCandidates.size());
+		buildGroupHulls();
+		return true;
+	}
+
+	mCurrentVertex = best;
+	mHullIndices.push_back(mGroupVertexIds[best]);
+	mStackTop++;
+	return true;
+}
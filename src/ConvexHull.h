@@ -1,24 +1,84 @@
 #pragma once
 
 #include "Vector2.h"
+#include "PointSet.h"
+#include "Predicates.h"
+#include "RadixSort.h"
 
 class ConvexHull
 {
 public:
-	ConvexHull(std::vector<Vector2f> &points);
+	enum class Algorithm
+	{
+		GrahamScan,		// Angular sort around the bottom point, keeps collinear boundary points
+		MonotoneChain,	// Andrew's lexicographic sort, lower then upper hull, corners only
+		Chan			// Output-sensitive O(n log h), gift wrapping over hulls of small groups,
+						// same result as MonotoneChain
+	};
+
+	// Points discarded before sorting
+	enum class Culling
+	{
+		None,
+		AklToussaint	// Points strictly inside the octagon of the x, y, x+y, x-y extremes
+	};
+
+	// threadCount == 0 uses all hardware threads, they cull and reduce
+	// contiguous chunks to their own hull before the sequential scan,
+	// the resulting hull is the same for any thread count
+	// GrahamScan without culling has no candidates to reduce, only the radix sort
+	// of its angle keys uses the threads, the rest runs on the calling thread
+	ConvexHull(PointSet &&points,
+			   Algorithm algorithm = Algorithm::GrahamScan,
+			   Culling culling = Culling::None,
+			   size_t threadCount = 1);
+	ConvexHull(std::vector<Vector2f> &points,
+			   Algorithm algorithm = Algorithm::GrahamScan,
+			   Culling culling = Culling::None,
+			   size_t threadCount = 1);
+	ConvexHull(Vector2SoA &points,
+			   Algorithm algorithm = Algorithm::GrahamScan,
+			   Culling culling = Culling::None,
+			   size_t threadCount = 1);
 	~ConvexHull();
 
 	void process();
 	bool advance();
 	void extractLineSegmentIndices(std::vector<uint32_t> &indices) const;
-	const Vector2f* data() const { return mPoints.data(); }
+	// nullptr when the input was given as SoA
+	const Vector2f* data() const { return mPoints.aosData(); }
 
 private:
+	// Candidate of the monotone chain, the point is recovered from its lexicographic key
+	using ChainPoint = Utils::KeyedId<uint64_t>;
+
 	void findBottomPoint();
 	void initIndices();
+	// Fill mHullIndices with the points that may be on the hull
+	void findCandidates();
+	// Ids of points [first, last) on or outside their extreme octagon
+	void cullInteriorPoints(size_t first, size_t last, std::vector<size_t>& outIds) const;
 	void sort();
+	// Keys of the given points, sorted lexicographically without duplicates
+	void makeChainPoints(const size_t* ids, size_t count, std::vector<ChainPoint>& outPoints,
+						 size_t threadCount = 1) const;
+	static void sortChainPoints(std::vector<ChainPoint>& points, size_t threadCount);
+	// Ids of the corners of sorted points, counter-clockwise from the first one
+	static void chainCorners(const std::vector<ChainPoint>& points, std::vector<size_t>& outIds);
 	void preprocess();
 
+	bool advanceGrahamScan();
+	bool advanceMonotoneChain();
+	// One gift wrapping step, restarts with larger groups when the hull outgrows them
+	bool advanceChan();
+	// Hulls of groups of mGroupSize candidates, wrapping restarts at the smallest point
+	void buildGroupHulls();
+	// Position of the vertex of a group hull that the whole group lies left of,
+	// seen from p, cNoVertex if there is none
+	size_t groupTangent(size_t group, const Vector2f& p) const;
+	// Point at a sorted position of the monotone chain
+	Vector2f chainPoint(size_t pos) const;
+
 	bool toLeft(const Vector2f &vecOrigin,
 				const Vector2f &vecTarget,
 				const Vector2f &targetPoint) const
@@ -27,13 +87,35 @@ private:
 		{
 			return false;
 		}
-		return cross(vecTarget - vecOrigin, targetPoint - vecOrigin) >= 0;
+		return Predicates::orient2d(vecOrigin, vecTarget, targetPoint) >= 0;
 	}
 	
 private:
-	std::vector<Vector2f> mPoints;
+	PointSet mPoints;
+	Algorithm mAlgorithm;
+	Culling mCulling;
+	size_t mThreadCount;
+	// Candidate points, bottom point first, the prefix up to mStackTop is the hull
+	// For the monotone chain the stack holds positions in mChainPoints instead
 	std::vector<size_t> mHullIndices;
 
 	size_t mStackTop;
 	size_t mProcessPos;
+
+	// Monotone chain only
+	std::vector<ChainPoint> mChainPoints;
+	// Stack entries at or below it are never popped, 1 on the lower hull,
+	// size of the lower hull on the upper one
+	size_t mChainFloor;
+
+	// Chan's algorithm only, the stack is the wrapped hull so far
+	std::vector<size_t> mCandidates;
+	size_t mGroupSize;
+	// Corners of all group hulls, counter-clockwise per group
+	std::vector<Vector2f> mGroupVertices;
+	std::vector<size_t> mGroupVertexIds;
+	// Group g owns vertex positions [mGroupOffsets[g], mGroupOffsets[g + 1])
+	std::vector<size_t> mGroupOffsets;
+	size_t mStartVertex;
+	size_t mCurrentVertex;
 };
\ No newline at end of file
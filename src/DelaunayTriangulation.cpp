@@ -1,17 +1,48 @@
 #include "DelaunayTriangulation.h"
 #include "Utils.h"
+#include "Predicates.h"
+#include "SpatialSort.h"
 
-DelaunayTriangulation::DelaunayTriangulation(std::vector<Vector2f>& inPoints)
+namespace
+{
+
+// Refinement leaves edges this many float ulps of their coordinates long alone,
+// the rounded circumcenter of a smaller triangle strays too far to improve it
+const double cMinRefineEdgeUlps = 256;
+
+double lengthSq(const Vector2f& p, const Vector2f& q)
+{
+	const double dx = double(q.x) - p.x;
+	const double dy = double(q.y) - p.y;
+	return dx * dx + dy * dy;
+}
+
+}
+
+template <typename MeshType>
+DelaunayTriangulationT<MeshType>::DelaunayTriangulationT(PointSet&& inPoints,
+														 InsertionOrder order,
+														 PointLocation location)
 	: mPoints(std::move(inPoints))
+	, mInputPointCount(mPoints.size())
+	, mLocation(location)
+	, mLastFaceId(0)
+	, mMaxRatioSq(0)
+	, mMaxArea(0)
 {
-	if (mPoints.size() > 2)
+	if (mPoints.size() > 2 && mPoints.size() <= maxMeshPointCount())
 	{
+		initInsertionOrder(order);
+
 		// Pick 3 points to form the first triangle
 		// Find left most pt, add pt beyond
 		initFirstTriangle();
 
 		// Initialize bucketing
-		initBucket();
+		if (mLocation == PointLocation::Bucketing)
+		{
+			initBucket();
+		}
 
 		// for pt in bucket
 		//     insert pt in bucket
@@ -24,26 +55,44 @@ DelaunayTriangulation::DelaunayTriangulation(std::vector<Vector2f>& inPoints)
 	}
 }
 
-DelaunayTriangulation::~DelaunayTriangulation()
+template <typename MeshType>
+DelaunayTriangulationT<MeshType>::DelaunayTriangulationT(std::vector<Vector2f>& inPoints,
+														 InsertionOrder order,
+														 PointLocation location)
+	: DelaunayTriangulationT(PointSet(inPoints), order, location)
+{
+}
+
+template <typename MeshType>
+DelaunayTriangulationT<MeshType>::DelaunayTriangulationT(Vector2SoA& inPoints,
+														 InsertionOrder order,
+														 PointLocation location)
+	: DelaunayTriangulationT(PointSet(inPoints), order, location)
+{
+}
+
+template <typename MeshType>
+DelaunayTriangulationT<MeshType>::~DelaunayTriangulationT()
 {
 }
 
-void DelaunayTriangulation::initFirstTriangle()
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::initFirstTriangle()
 {
-	std::vector<HDS::HalfEdge>& hes = mMesh.halfedges;
+	std::vector<HalfEdge>& hes = mMesh.halfedges;
 
 	mMesh.halfedges.reserve(3 * mPoints.size());
 
 	size_t leftMostPtId = 0;
-	const Vector2f* pt = &mPoints.front();
+	Vector2f pt = mPoints[0];
 
 	// find left most point
 	for (size_t i = 1; i < mPoints.size(); i++)
 	{
-		const Vector2f* curPt = &mPoints[i];
+		const Vector2f curPt = mPoints[i];
 
-		if ((curPt->x < pt->x) ||
-			(curPt->x == pt->x && curPt->y < pt->y))
+		if ((curPt.x < pt.x) ||
+			(curPt.x == pt.x && curPt.y < pt.y))
 		{
 			leftMostPtId = i;
 			pt = curPt;
@@ -63,42 +112,53 @@ void DelaunayTriangulation::initFirstTriangle()
 	linkEdgeLoop(hes[0], hes[1], hes[2]);
 }
 
-void DelaunayTriangulation::initBucket()
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::initBucket()
 {
 	size_t ptCount = mPoints.size();
 
-	for (size_t i = 0; i < ptCount; i++)
+	// Every insertion adds 2 faces to the first one
+	mBucketHead.resize(2 * ptCount - 1, cInvalidIndex);
+	mBucketNext.resize(ptCount, cInvalidIndex);
+	mVertexToBucketMap.resize(ptCount, 0);
+
+	size_t skipPtId = mMesh.halfedges[2].vid;
+	for (size_t i = ptCount; i-- > 0;)
 	{
-		if (i != mMesh.halfedges[2].vid)
+		if (i != skipPtId)
 		{
-			mBucket[0].push_back(i);
+			reBucketPoint(i, 0);
 		}
 	}
-	mVertexToBucketMap.resize(ptCount, 0);
+	mVertexToBucketMap[skipPtId] = cInvalidIndex;
 }
 
-void DelaunayTriangulation::reBucketPoint(size_t vid, size_t fid)
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::reBucketPoint(size_t vid, size_t fid)
 {
-	mBucket[fid].push_back(vid);
+	mBucketNext[vid] = mBucketHead[fid];
+	mBucketHead[fid] = vid;
 	mVertexToBucketMap[vid] = fid;
 }
 
-void DelaunayTriangulation::reBucketFlip(const HDS::HalfEdge& he)
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::detachBucket(size_t fid)
+{
+	size_t head = mBucketHead[fid];
+	mBucketHead[fid] = cInvalidIndex;
+	return head;
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::reBucketFlip(const HalfEdge& he)
 {
-	const HDS::HalfEdge& hef = *he.flip();
+	const HalfEdge& hef = *he.flip();
 	size_t fid0 = he.fid;
 	size_t fid1 = hef.fid;
 	size_t vid0 = he.vid;
 	size_t vid1 = hef.vid;
 
-	std::vector<size_t>& bucket1 = mBucket[fid0];
-	std::vector<size_t>& bucket2 = mBucket[fid1];
-
-	std::vector<size_t> dirtyPts;
-	dirtyPts.insert(dirtyPts.end(), bucket1.begin(), bucket1.end());
-	dirtyPts.insert(dirtyPts.end(), bucket2.begin(), bucket2.end());
-	bucket1.clear();
-	bucket2.clear();
+	std::array<size_t, 2> dirtyLists{ detachBucket(fid0), detachBucket(fid1) };
 
 	//                     *
 	//                   / |
@@ -112,21 +172,24 @@ void DelaunayTriangulation::reBucketFlip(const HDS::HalfEdge& he)
 	//                 \   |
 	//                   \ |
 	//                     *
-	for (size_t dirtyPid : dirtyPts)
+	for (size_t dirtyPid : dirtyLists)
 	{
-		if (toLeft(vid0, vid1, dirtyPid))
-		{
-			reBucketPoint(dirtyPid, fid0);
-		}
-		else
+		while (dirtyPid != cInvalidIndex)
 		{
-			reBucketPoint(dirtyPid, fid1);
+			size_t nextPid = mBucketNext[dirtyPid];
+			// Inserted points are dropped from buckets
+			if (mVertexToBucketMap[dirtyPid] != cInvalidIndex)
+			{
+				reBucketPoint(dirtyPid, toLeft(vid0, vid1, dirtyPid) ? fid0 : fid1);
+			}
+			dirtyPid = nextPid;
 		}
 	}
 }
 
-void DelaunayTriangulation::reBucketStarSplit(
-	const HDS::HalfEdge& he0, const HDS::HalfEdge& he1, const HDS::HalfEdge& he2)
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::reBucketStarSplit(
+	const HalfEdge& he0, const HalfEdge& he1, const HalfEdge& he2)
 {
 	size_t vId = he1.vid;
 	size_t vid0 = he0.next()->vid;
@@ -137,18 +200,8 @@ void DelaunayTriangulation::reBucketStarSplit(
 	size_t fid1 = he1.fid;
 	size_t fid2 = he2.fid;
 
-	// Clear buckets
-	std::vector<size_t>& bucket0 = mBucket[fid0];
-	std::vector<size_t>& bucket1 = mBucket[fid1];
-	std::vector<size_t>& bucket2 = mBucket[fid1];
-
-	std::vector<size_t> dirtyPts;
-	dirtyPts.insert(dirtyPts.end(), bucket0.begin(), bucket0.end());
-	dirtyPts.insert(dirtyPts.end(), bucket1.begin(), bucket1.end());
-	dirtyPts.insert(dirtyPts.end(), bucket2.begin(), bucket2.end());
-	bucket0.clear();
-	bucket1.clear();
-	bucket2.clear();
+	// Only the split face owns points, new faces start empty
+	size_t dirtyPtId = detachBucket(fid0);
 
 	//              * v2
 	//            / ^ \
@@ -160,85 +213,171 @@ void DelaunayTriangulation::reBucketStarSplit(
 	//      /   he0    he1  \
 	//     / |/_    f0   _\| \
 	// v0 *-------------------* v1
-	for (auto dirtyPtId : dirtyPts)
+	while (dirtyPtId != cInvalidIndex)
 	{
-		if (dirtyPtId == vId)
-		{
-			continue;
-		}
-		if (toLeft(vId, vid0, dirtyPtId))
-		{
-			if (toLeft(vId, vid1, dirtyPtId))
-			{
-				// in f1
-				reBucketPoint(dirtyPtId,fid1);
-			}
-			else
-			{
-				// in f0
-				reBucketPoint(dirtyPtId, fid0);
-			}
-		}
-		else
+		size_t nextPtId = mBucketNext[dirtyPtId];
+		if (mVertexToBucketMap[dirtyPtId] != cInvalidIndex)
 		{
-			if (toLeft(vId, vid2, dirtyPtId))
+			if (toLeft(vId, vid0, dirtyPtId))
 			{
-				// in f2
-				reBucketPoint(dirtyPtId, fid2);
+				// in f1 or f0
+				reBucketPoint(dirtyPtId, toLeft(vId, vid1, dirtyPtId) ? fid1 : fid0);
 			}
 			else
 			{
-				//in f1
-				reBucketPoint(dirtyPtId, fid1);
+				// in f2 or f1
+				reBucketPoint(dirtyPtId, toLeft(vId, vid2, dirtyPtId) ? fid2 : fid1);
 			}
 		}
+		dirtyPtId = nextPtId;
 	}
 }
 
-size_t DelaunayTriangulation::onEdge(size_t ptId, size_t fid)
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::onEdge(size_t ptId, size_t fid, size_t& outVertexId)
 {
-	const HDS::HalfEdge* he = mMesh.heFromFace(fid);
-	const HDS::HalfEdge* curHE = he;
+	const HalfEdge* he[3];
+	he[0] = mMesh.heFromFace(fid);
+	he[1] = he[0]->next();
+	he[2] = he[1]->next();
+	const Vector2f pt = mPoints[ptId];
 
-	do
+	// check exact collinearity, an edge to an infinite vertex only holds its finite end
+	bool collinear[3];
+	for (int i = 0; i < 3; i++)
 	{
-		size_t curVid = curHE->vid;
-		size_t nextVid = curHE->next()->vid;
+		const size_t curVid = he[i]->vid;
+		const size_t nextVid = he[(i + 1) % 3]->vid;
 		if (curVid < cVertexIdNegTwo && nextVid < cVertexIdNegTwo)
 		{
-			// check cross product == 0
-			float area = cross(mPoints[nextVid] - mPoints[curVid], mPoints[ptId] - mPoints[curVid]);
-			if (area < std::numeric_limits<float>::epsilon() &&
-				area > -std::numeric_limits<float>::epsilon())
+			collinear[i] = Predicates::orient2d(mPoints[curVid], mPoints[nextVid], pt) == 0;
+		}
+		else
+		{
+			const size_t finiteVid = std::min(curVid, nextVid);
+			collinear[i] = finiteVid < cVertexIdNegTwo && mPoints[finiteVid] == pt;
+		}
+	}
+
+	// Collinear with both edges at a corner, the point is that vertex
+	outVertexId = cInvalidIndex;
+	for (int i = 0; i < 3; i++)
+	{
+		if (collinear[i] && collinear[(i + 2) % 3])
+		{
+			outVertexId = he[i]->vid;
+			return cInvalidIndex;
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		const size_t curVid = he[i]->vid;
+		const size_t nextVid = he[(i + 1) % 3]->vid;
+		if (collinear[i] && curVid < cVertexIdNegTwo && nextVid < cVertexIdNegTwo)
+		{
+			// the point has to be between both ends
+			const Vector2f p0 = mPoints[curVid];
+			const Vector2f p1 = mPoints[nextVid];
+			if (std::min(p0.x, p1.x) <= pt.x && pt.x <= std::max(p0.x, p1.x) &&
+				std::min(p0.y, p1.y) <= pt.y && pt.y <= std::max(p0.y, p1.y))
 			{
-				return curHE->index;
+				return mMesh.heIndex(he[i]);
 			}
 		}
-		curHE = curHE->next();
-	} while (curHE != he);
+	}
 	return cInvalidIndex;
 }
 
-bool DelaunayTriangulation::toLeft(size_t vId0, size_t vId1, size_t pId)
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::toLeft(size_t vId0, size_t vId1, size_t pId)
 {
+	// P-2 sits far below and slightly right of every point, P-1 far above and slightly left,
+	// so ties on x are broken by y the same way for both
+	const Vector2f p = mPoints[pId];
+	const Vector2f v0 = mPoints[vId0];
 	if (vId1 == cVertexIdNegTwo)
 	{
-		return mPoints[pId].x > mPoints[vId0].x;
+		return p.x > v0.x || (p.x == v0.x && p.y > v0.y);
 	}
 	if (vId1 == cVertexIdNegOne)
 	{
-		return mPoints[pId].x < mPoints[vId0].x;
+		return p.x < v0.x || (p.x == v0.x && p.y < v0.y);
+	}
+
+	return Predicates::orient2d(mPoints[vId0], mPoints[vId1], mPoints[pId]) > 0;
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::toRight(size_t oriVid, size_t targVid, size_t curVid)
+{
+	// Strictly right, only called with finite end points
+	return toLeft(targVid, oriVid, curVid);
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::outsideEdge(size_t vId0, size_t vId1, size_t pId)
+{
+	if (vId0 >= cVertexIdNegTwo)
+	{
+		// Edge P-2 to P-1 bounds the whole plane
+		if (vId1 >= cVertexIdNegTwo)
+		{
+			return false;
+		}
+		// Ties go to the face where the infinite point is the target
+		return toLeft(vId1, vId0, pId);
+	}
+	if (vId1 >= cVertexIdNegTwo)
+	{
+		// A copy of v0 lies on neither side, like a point on a finite edge
+		return mPoints[pId] != mPoints[vId0] && !toLeft(vId0, vId1, pId);
 	}
 
-	return cross(mPoints[vId1] - mPoints[vId0], mPoints[pId] - mPoints[vId0]) > 0;
+	return Predicates::orient2d(mPoints[vId0], mPoints[vId1], mPoints[pId]) < 0;
 }
 
-bool DelaunayTriangulation::toRight(size_t oriVid, size_t targVid, size_t curVid)
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::locateFace(size_t ptId)
 {
-	return !toLeft(oriVid, targVid, curVid);
+	const HalfEdge* curHE = mMesh.heFromFace(mLastFaceId);
+	// Edge we entered the current face through, no need to test it again
+	const HalfEdge* entryHE = nullptr;
+
+	while (true)
+	{
+		// Randomize the first tested edge to avoid cycling in degenerate cases
+		for (size_t i = mWalkRand() % 3; i > 0; i--)
+		{
+			curHE = curHE->next();
+		}
+
+		const HalfEdge* exitHE = nullptr;
+		for (int i = 0; i < 3; i++, curHE = curHE->next())
+		{
+			if (curHE != entryHE &&
+				outsideEdge(curHE->vid, curHE->next()->vid, ptId))
+			{
+				exitHE = curHE;
+				break;
+			}
+		}
+
+		if (exitHE == nullptr)
+		{
+			return curHE->fid;
+		}
+
+		// Every point lies inside the initial triangle, copies of its finite corner included,
+		// so the walk never leaves through boundary edges
+		assert(!exitHE->isBoundary());
+		entryHE = exitHE->flip();
+		curHE = entryHE;
+	}
 }
 
-bool DelaunayTriangulation::inCircle(size_t triP0, size_t triP1, size_t triP2, size_t targ)
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::inCircle(size_t triP0, size_t triP1, size_t triP2, size_t targ)
 {
 	// P0 is the point we inserted from previous step
 	// P1 P2 cannot be negative at the same time, since we stop at boundary edge
@@ -258,67 +397,135 @@ bool DelaunayTriangulation::inCircle(size_t triP0, size_t triP1, size_t triP2, s
 	return Utils::inCircle(mPoints[triP0], mPoints[triP1], mPoints[triP2], mPoints[targ]);
 }
 
-void DelaunayTriangulation::flipEdge(HDS::HalfEdge& he, HDS::HalfEdge& hef)
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::flipEdge(HalfEdge& he, HalfEdge& hef)
 {
-	HDS::HalfEdge& he1 = *he.next();
-	HDS::HalfEdge& he2 = *he.prev();
-	HDS::HalfEdge& he3 = *hef.next();
-	HDS::HalfEdge& he4 = *hef.prev();
+	HalfEdge& he1 = *he.next();
+	HalfEdge& he2 = *he.prev();
+	HalfEdge& he3 = *hef.next();
+	HalfEdge& he4 = *hef.prev();
 
+	if (!mVertexEdge.empty())
+	{
+		// The old end points keep the edges next to the flipped one
+		mVertexEdge[he.vid] = mMesh.heIndex(&he3);
+		mVertexEdge[hef.vid] = mMesh.heIndex(&he1);
+	}
 	he.vid = he2.vid;
 	hef.vid = he4.vid;
 	linkEdgeLoop(he, he4, he1);
-	linkFace(he, he4, he1, *mMesh.faceFromHe(he.index));
+	mMesh.linkFace(he, he4, he1, mMesh.faces[he.fid]);
 
 	linkEdgeLoop(hef, he2, he3);
-	linkFace(hef, he2, he3, *mMesh.faceFromHe(hef.index));
+	mMesh.linkFace(hef, he2, he3, mMesh.faces[hef.fid]);
 }
 
-void DelaunayTriangulation::insertIntoFace(size_t vId, size_t fid)
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::insertIntoFace(size_t vId, size_t fid)
 {
-	HDS::Face* newFace = nullptr;
-	HDS::HalfEdge* newHE = nullptr;
+	Face* newFace[2];
+	HalfEdge* newHE[6];
 	mMesh.insertNewVertexInFace(newHE, newFace, vId, fid);
+	if (!mVertexEdge.empty())
+	{
+		mConstrained.resize(mMesh.halfedges.size(), 0);
+		mVertexEdge[vId] = mMesh.heIndex(newHE[0]);
+	}
 
 	// update bucket
-	reBucketStarSplit(newHE[0], newHE[2], newHE[4]);
+	if (mLocation == PointLocation::Bucketing)
+	{
+		reBucketStarSplit(*newHE[0], *newHE[2], *newHE[4]);
+	}
+	mLastFaceId = newHE[0]->fid;
 
 	// Legalize edges
-	std::vector<HDS::HalfEdge*> frontierEdges{
-		newHE[0].next(), newHE[2].next(), newHE[4].next()
+	std::vector<HalfEdge*> frontierEdges{
+		newHE[0]->next(), newHE[2]->next(), newHE[4]->next()
 	};
 	legalizeEdge(frontierEdges, vId);
 }
 
-void DelaunayTriangulation::insertAtEdge(size_t vId, size_t heId)
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::insertAtEdge(size_t vId, size_t heId)
 {
-	HDS::Face* newFace = nullptr;
-	HDS::HalfEdge* newHE = nullptr;
+	if (mMesh.halfedges[heId].isBoundary())
+	{
+		insertAtBoundaryEdge(vId, heId);
+		return;
+	}
+	Face* newFace[2];
+	HalfEdge* newHE[6];
+	// The split edge keeps its index but now starts at the new vertex
+	const size_t oldOrigin = mMesh.halfedges[heId].vid;
+	const size_t oldOriginEdge = mMesh.heIndex(mMesh.halfedges[heId].flip()->next());
+	const bool splitConstraint = isConstrained(mMesh.halfedges[heId]);
 	mMesh.insertNewVertexOnEdge(newHE, newFace, vId, heId);
+	if (!mVertexEdge.empty())
+	{
+		mConstrained.resize(mMesh.halfedges.size(), 0);
+		mVertexEdge[oldOrigin] = oldOriginEdge;
+		mVertexEdge[vId] = heId;
+		// Both halves of a split constraint stay constrained
+		if (splitConstraint)
+		{
+			markConstrained(*newHE[2]);
+		}
+	}
 
 	// re-bucket
-	reBucketFlip(newHE[1]);
-	reBucketFlip(newHE[5]);
+	if (mLocation == PointLocation::Bucketing)
+	{
+		reBucketFlip(*newHE[1]);
+		reBucketFlip(*newHE[5]);
+	}
+	mLastFaceId = newHE[1]->fid;
 
 	// Legalize edges
-	std::vector<HDS::HalfEdge*> frontierEdges{
-		newHE[0].prev(), newHE[1].next(), newHE[3].next(), newHE[5].next() };
+	std::vector<HalfEdge*> frontierEdges{
+		newHE[0]->prev(), newHE[1]->next(), newHE[3]->next(), newHE[5]->next() };
+	legalizeEdge(frontierEdges, vId);
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::insertAtBoundaryEdge(size_t vId, size_t heId)
+{
+	// Hull edges only exist once the infinite faces are gone, buckets are empty by then
+	Face* newFace[1];
+	HalfEdge* newHE[3];
+	const size_t oldOrigin = mMesh.halfedges[heId].vid;
+	const bool splitConstraint = isConstrained(mMesh.halfedges[heId]);
+	mMesh.insertNewVertexOnBoundaryEdge(newHE, newFace, vId, heId);
+	if (!mVertexEdge.empty())
+	{
+		mConstrained.resize(mMesh.halfedges.size(), 0);
+		mVertexEdge[oldOrigin] = mMesh.heIndex(newHE[2]);
+		mVertexEdge[vId] = heId;
+		if (splitConstraint)
+		{
+			markConstrained(*newHE[2]);
+		}
+	}
+	mLastFaceId = newHE[1]->fid;
+
+	std::vector<HalfEdge*> frontierEdges{ mMesh.halfedges[heId].next(), newHE[1]->next() };
 	legalizeEdge(frontierEdges, vId);
 }
 
-void DelaunayTriangulation::legalizeEdge(std::vector<HDS::HalfEdge*>& frontierEdges,
-										 size_t insertedPtId)
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::legalizeEdge(std::vector<HalfEdge*>& frontierEdges,
+													size_t insertedPtId)
 {
 	while (!frontierEdges.empty())
 	{
-		HDS::HalfEdge* curHE = frontierEdges.back();
+		HalfEdge* curHE = frontierEdges.back();
 		frontierEdges.pop_back();
 
-		if (curHE->isBoundary())
+		if (curHE->isBoundary() || isConstrained(*curHE))
 		{
 			continue;
 		}
-		HDS::HalfEdge* curHEF = curHE->flip();
+		HalfEdge* curHEF = curHE->flip();
 		size_t flipPid = curHEF->prev()->vid;
 
 		// If the vertex P on the opposite triangle lies in Circle(A, B, C)
@@ -334,92 +541,1203 @@ void DelaunayTriangulation::legalizeEdge(std::vector<HDS::HalfEdge*>& frontierEd
 			frontierEdges.push_back(curHEF->next());
 
 			flipEdge(*curHE, *curHEF);
-			reBucketFlip(*curHE/*, *curHEF*/);
+			if (mLocation == PointLocation::Bucketing)
+			{
+				reBucketFlip(*curHE/*, *curHEF*/);
+			}
 		}
 	}
 }
 
-void DelaunayTriangulation::traversalPts()
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::markConstrained(HalfEdge& he)
 {
-	size_t skipPtId = mMesh.halfedges[2].vid;
-	for (size_t pointId = 0; pointId < mPoints.size(); pointId++)
+	mConstrained[mMesh.heIndex(&he)] = 1;
+	if (!he.isBoundary())
+	{
+		mConstrained[mMesh.heIndex(he.flip())] = 1;
+	}
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::initConstraints()
+{
+	mConstrained.assign(mMesh.halfedges.size(), 0);
+	mVertexEdge.assign(mPoints.size(), cInvalidIndex);
+	for (const HalfEdge& he : mMesh.halfedges)
 	{
-		if (pointId == skipPtId)
+		if (!he.isInvalid())
 		{
-			continue;
+			mVertexEdge[he.vid] = mMesh.heIndex(&he);
 		}
+	}
+}
 
-		size_t faceId = mVertexToBucketMap[pointId];
-		size_t edgeId = onEdge(pointId, faceId);
-		if (edgeId == cInvalidIndex)
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::insertConstraint(size_t pid0, size_t pid1)
+{
+	if (pid0 == pid1 || pid0 >= mPoints.size() || pid1 >= mPoints.size())
+	{
+		return false;
+	}
+	if (mVertexEdge.empty())
+	{
+		initConstraints();
+	}
+
+	// Each point on the segment ends one recovered edge and starts the next
+	size_t fromPid = pid0;
+	while (fromPid != pid1)
+	{
+		size_t nextPid = cInvalidIndex;
+		HalfEdge* he = segmentStart(fromPid, pid1, nextPid);
+		if (he == nullptr)
+		{
+			return false;
+		}
+		if (nextPid == cInvalidIndex)
 		{
-			// Insert into face
-			insertIntoFace(pointId, faceId);
+			nextPid = recoverSegment(fromPid, pid1, he);
+			if (nextPid == cInvalidIndex)
+			{
+				return false;
+			}
 		}
 		else
 		{
-			// Insert on edge
-			insertAtEdge(pointId, edgeId);
+			markConstrained(*he);
 		}
+		fromPid = nextPid;
 	}
+	return true;
 }
 
-void DelaunayTriangulation::finalizeHDS()
+template <typename MeshType>
+typename DelaunayTriangulationT<MeshType>::HalfEdge* DelaunayTriangulationT<MeshType>::firstOutgoing(size_t pid)
 {
-	for (HDS::HalfEdge& he : mMesh.halfedges)
+	const size_t startId = mVertexEdge[pid];
+	if (startId == cInvalidIndex)
 	{
-		if (he.vid >= cVertexIdNegTwo && !he.isInvalid())
+		return nullptr;
+	}
+	// Rewind clockwise to the hull, if pid is on it
+	HalfEdge* first = &mMesh.halfedges[startId];
+	while (!first->isBoundary())
+	{
+		HalfEdge* cw = first->flip()->next();
+		if (cw == &mMesh.halfedges[startId])
 		{
-			HDS::HalfEdge* curHE = &he;
-			mMesh.faces[he.fid].setToInvalid();
-			do
+			break;
+		}
+		first = cw;
+	}
+	return first;
+}
+
+template <typename MeshType>
+typename DelaunayTriangulationT<MeshType>::HalfEdge* DelaunayTriangulationT<MeshType>::segmentStart(size_t fromPid, size_t toPid, size_t& outNextPid)
+{
+	HalfEdge* first = firstOutgoing(fromPid);
+	if (first == nullptr)
+	{
+		return nullptr;
+	}
+	const Vector2f from = mPoints[fromPid];
+	const Vector2f to = mPoints[toPid];
+	// Points on the line towards toPid, not behind fromPid
+	auto onSegment = [&](size_t pid)
+	{
+		const Vector2f p = mPoints[pid];
+		return pid == toPid
+			|| (Predicates::orient2d(from, to, p) == 0 && dot(p - from, to - from) > 0);
+	};
+
+	HalfEdge* he = first;
+	while (true)
+	{
+		// Face (fromPid, v, w) counter-clockwise
+		const size_t v = he->next()->vid;
+		const size_t w = he->prev()->vid;
+		if (onSegment(v))
+		{
+			outNextPid = v;
+			return he;
+		}
+		if (Predicates::orient2d(from, mPoints[v], to) > 0 && Predicates::orient2d(from, mPoints[w], to) < 0)
+		{
+			return he->next();
+		}
+
+		HalfEdge* incoming = he->prev();
+		if (incoming->isBoundary())
+		{
+			// The last edge of the fan has no half-edge out of fromPid
+			if (onSegment(w))
 			{
-				HDS::HalfEdge* nextHE = curHE->next();
-				curHE->setToInvalid();
-				curHE->breakFlip();
-				curHE = nextHE;
-			} while (curHE != &he);
+				outNextPid = w;
+				return incoming;
+			}
+			return nullptr;
+		}
+		he = incoming->flip();
+		if (he == first)
+		{
+			return nullptr;
 		}
 	}
 }
 
-/*
-bool Delaunay::keepInsertion()
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::recoverSegment(size_t fromPid, size_t toPid, HalfEdge* firstCrossing)
 {
-	if (mUnusedPtIds.empty())
+	const Vector2f from = mPoints[fromPid];
+	const Vector2f to = mPoints[toPid];
+
+	// Walk the faces along the segment, every crossed edge goes from its right to its left
+	mCrossedEdges.clear();
+	size_t endPid = toPid;
+	HalfEdge* crossing = firstCrossing;
+	while (true)
 	{
-		return false;
+		// Running past the face count means degenerate faces sent the walk in circles
+		if (crossing->isBoundary() || isConstrained(*crossing)
+			|| mCrossedEdges.size() > mMesh.faces.size())
+		{
+			return cInvalidIndex;
+		}
+		mCrossedEdges.push_back(crossing);
+		HalfEdge* beyond = crossing->flip();
+		const size_t opposite = beyond->prev()->vid;
+		if (opposite == toPid)
+		{
+			break;
+		}
+		const double side = Predicates::orient2d(from, to, mPoints[opposite]);
+		if (side == 0)
+		{
+			// The segment passes through this point, recover up to it
+			endPid = opposite;
+			break;
+		}
+		crossing = side > 0 ? beyond->next() : beyond->prev();
 	}
-	size_t pointId = mUnusedPtIds.top();
 
-	size_t faceId = mVertexToBucketMap[pointId];
-	size_t edgeId = onEdge(pointId, faceId);
-	if (edgeId == cInvalidIndex)
+	const Vector2f end = mPoints[endPid];
+	auto crossesSegment = [&](const HalfEdge& he)
 	{
-		// Insert into face
-		insertIntoFace(pointId, faceId);
+		const double side0 = Predicates::orient2d(from, end, mPoints[he.vid]);
+		const double side1 = Predicates::orient2d(from, end, mPoints[he.next()->vid]);
+		return (side0 > 0 && side1 < 0) || (side0 < 0 && side1 > 0);
+	};
+
+	// Flip crossing edges of convex quads until none crosses, the ones in a
+	// reflex quad wait for their neighbours to be flipped first (Sloan)
+	// Quads with three collinear corners never become convex, a whole round
+	// of waiting edges means the segment cannot be recovered, as does running
+	// over the O(k^2) flips k crossings can take, which only degenerate faces cause
+	mNewEdges.clear();
+	const size_t crossingCount = mCrossedEdges.size();
+	const size_t flipLimit = crossingCount * crossingCount + crossingCount;
+	size_t flipCount = 0;
+	size_t waiting = 0;
+	bool blocked = false;
+	for (size_t i = 0; i < mCrossedEdges.size(); i++)
+	{
+		blocked = waiting > mCrossedEdges.size() - i || flipCount > flipLimit;
+		if (blocked)
+		{
+			break;
+		}
+		HalfEdge& he = *mCrossedEdges[i];
+		HalfEdge& hef = *he.flip();
+		if (!convexQuad(he))
+		{
+			mCrossedEdges.push_back(&he);
+			waiting++;
+			continue;
+		}
+		waiting = 0;
+		flipCount++;
+		flipEdge(he, hef);
+		if (crossesSegment(he))
+		{
+			mCrossedEdges.push_back(&he);
+		}
+		else
+		{
+			mNewEdges.push_back(&he);
+		}
 	}
-	else
+
+	// Restore the Delaunay property among the new edges, except for the segment itself,
+	// also after giving up so the flips done so far do not linger
+	for (HalfEdge* he : mNewEdges)
 	{
-		// Insert on edge
-		insertAtEdge(pointId, edgeId);
+		const size_t a = he->vid;
+		const size_t b = he->flip()->vid;
+		if (!blocked && ((a == fromPid && b == endPid) || (a == endPid && b == fromPid)))
+		{
+			markConstrained(*he);
+		}
+	}
+	bool flipped = true;
+	while (flipped)
+	{
+		flipped = false;
+		for (HalfEdge* he : mNewEdges)
+		{
+			if (isConstrained(*he))
+			{
+				continue;
+			}
+			HalfEdge& hef = *he->flip();
+			if (Utils::inCircle(mPoints[he->vid], mPoints[hef.vid], mPoints[he->prev()->vid],
+								mPoints[hef.prev()->vid])
+				&& convexQuad(*he))
+			{
+				flipEdge(*he, hef);
+				flipped = true;
+			}
+		}
 	}
+	return blocked ? cInvalidIndex : endPid;
+}
 
-	mUnusedPtIds.pop();
-	return true;
-}*/
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::convexQuad(const HalfEdge& he) const
+{
+	// The second test can only fail next to faces without area
+	const Vector2f p = mPoints[he.vid];
+	const Vector2f q = mPoints[he.flip()->vid];
+	const Vector2f r = mPoints[he.prev()->vid];
+	const Vector2f s = mPoints[he.flip()->prev()->vid];
+	const double sideP = Predicates::orient2d(r, s, p);
+	const double sideQ = Predicates::orient2d(r, s, q);
+	return ((sideP > 0 && sideQ < 0) || (sideP < 0 && sideQ > 0))
+		&& Predicates::orient2d(p, q, r) > 0 && Predicates::orient2d(p, q, s) < 0;
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::restoreDelaunay(std::vector<HalfEdge*>& dirtyEdges)
+{
+	while (!dirtyEdges.empty())
+	{
+		HalfEdge* he = dirtyEdges.back();
+		dirtyEdges.pop_back();
+		if (he->isInvalid() || isSegment(*he))
+		{
+			continue;
+		}
+		HalfEdge* hef = he->flip();
+		if (Utils::inCircle(mPoints[he->vid], mPoints[hef->vid], mPoints[he->prev()->vid],
+							mPoints[hef->prev()->vid])
+			&& convexQuad(*he))
+		{
+			dirtyEdges.push_back(he->next());
+			dirtyEdges.push_back(he->prev());
+			dirtyEdges.push_back(hef->next());
+			dirtyEdges.push_back(hef->prev());
+			flipEdge(*he, *hef);
+		}
+	}
+}
+
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::refine(float minAngle, float maxArea, size_t maxPointCount)
+{
+	initUpdates();
+
+	// The circumradius to shortest edge ratio of a triangle is 1 / (2 sin(a)) for its smallest angle a
+	const double sinAngle = std::sin(std::min(double(minAngle), 60.0) * 3.14159265358979323846 / 180.0);
+	mMaxRatioSq = sinAngle > 0 ? 0.25 / (sinAngle * sinAngle) : std::numeric_limits<double>::infinity();
+	mMaxArea = maxArea > 0 ? maxArea : std::numeric_limits<double>::infinity();
+
+	mBadTriangles = {};
+	mEncroached.clear();
+	for (size_t fid = 0; fid < mMesh.faces.size(); fid++)
+	{
+		if (!mMesh.faces[fid].isInvalid())
+		{
+			queueBadTriangle(fid);
+		}
+	}
+	for (const HalfEdge& he : mMesh.halfedges)
+	{
+		if (!he.isInvalid() && isSegment(he) && encroaches(he, mPoints[he.prev()->vid]))
+		{
+			queueSubsegment(he);
+		}
+	}
+
+	// The mesh indices bound the points as well
+	const size_t room = mPoints.size() < maxMeshPointCount() ? maxMeshPointCount() - mPoints.size() : 0;
+	maxPointCount = std::min(maxPointCount, room);
+	size_t addedCount = 0;
+	while (addedCount < maxPointCount)
+	{
+		if (!mEncroached.empty())
+		{
+			const Subsegment segment = mEncroached.back();
+			mEncroached.pop_back();
+			addedCount += splitSubsegment(segment) ? 1 : 0;
+			continue;
+		}
+		if (mBadTriangles.empty())
+		{
+			break;
+		}
+		const BadTriangle triangle = mBadTriangles.top();
+		mBadTriangles.pop();
+		if (mMesh.faces[triangle.fid].isInvalid())
+		{
+			continue;
+		}
+		const HalfEdge* he = mMesh.heFromFace(triangle.fid);
+		std::array<size_t, 3> vids{ he->vid, he->next()->vid, he->prev()->vid };
+		const Vector2f a = mPoints[vids[0]];
+		const Vector2f b = mPoints[vids[1]];
+		const Vector2f c = mPoints[vids[2]];
+		std::sort(vids.begin(), vids.end());
+		if (vids != triangle.vids)
+		{
+			continue;
+		}
+
+		const double bx = double(b.x) - a.x, by = double(b.y) - a.y;
+		const double cx = double(c.x) - a.x, cy = double(c.y) - a.y;
+		const double d = 2 * (bx * cy - by * cx);
+		const double b2 = bx * bx + by * by;
+		const double c2 = cx * cx + cy * cy;
+		const Vector2f center(static_cast<float>(a.x + (cy * b2 - by * c2) / d),
+							  static_cast<float>(a.y + (bx * c2 - cx * b2) / d));
+
+		// A segment between the triangle and its circumcenter, or one the circumcenter
+		// encroaches upon, is split first and the triangle tried again
+		size_t blockingEdge = cInvalidIndex;
+		const size_t fid = walkTowards(triangle.fid, center, blockingEdge);
+		mCavitySegments.clear();
+		if (fid == cInvalidIndex)
+		{
+			const HalfEdge& segment = mMesh.halfedges[blockingEdge];
+			mCavitySegments.push_back({ blockingEdge, segment.vid, segment.next()->vid });
+		}
+		else
+		{
+			collectEncroached(fid, center);
+		}
+		if (!mCavitySegments.empty())
+		{
+			bool split = false;
+			for (const Subsegment& segment : mCavitySegments)
+			{
+				if (addedCount < maxPointCount && splitSubsegment(segment))
+				{
+					addedCount++;
+					split = true;
+				}
+			}
+			// Segments too short to split leave the triangle as it is
+			if (split)
+			{
+				mBadTriangles.push(triangle);
+			}
+			continue;
+		}
+
+		// Circumcenters rounding onto a corner of their face are dropped
+		const HalfEdge* faceHE = mMesh.heFromFace(fid);
+		if (mPoints[faceHE->vid] == center || mPoints[faceHE->next()->vid] == center
+			|| mPoints[faceHE->prev()->vid] == center)
+		{
+			continue;
+		}
+		const size_t pid = addPoint(center);
+		size_t vertexId;
+		const size_t edgeId = onEdge(pid, fid, vertexId);
+		if (edgeId == cInvalidIndex)
+		{
+			insertIntoFace(pid, fid);
+		}
+		else
+		{
+			insertAtEdge(pid, edgeId);
+		}
+		addedCount++;
+		checkStar(pid);
+	}
+	return addedCount;
+}
+
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::addPoint(const Vector2f& p)
+{
+	const size_t pid = mPoints.size();
+	assert(pid < maxMeshPointCount());
+	mPoints.push_back(p);
+	mVertexEdge.push_back(cInvalidIndex);
+	return pid;
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::encroaches(const HalfEdge& he, const Vector2f& p) const
+{
+	const Vector2f a = mPoints[he.vid];
+	const Vector2f b = mPoints[he.next()->vid];
+	return (double(a.x) - p.x) * (double(b.x) - p.x) + (double(a.y) - p.y) * (double(b.y) - p.y) < 0;
+}
+
+template <typename MeshType>
+double DelaunayTriangulationT<MeshType>::badness(size_t fid) const
+{
+	const HalfEdge* he = mMesh.heFromFace(fid);
+	const Vector2f a = mPoints[he->vid];
+	const Vector2f b = mPoints[he->next()->vid];
+	const Vector2f c = mPoints[he->prev()->vid];
+	const double area = 0.5 * Predicates::orient2d(a, b, c);
+	if (area <= 0)
+	{
+		// Faces without area between duplicates have no circumcenter
+		return 0;
+	}
+	const double ab = lengthSq(a, b);
+	const double bc = lengthSq(b, c);
+	const double ca = lengthSq(c, a);
+	const double shortest = std::min({ ab, bc, ca });
+	const double ulp = std::max({ std::fabs(a.x), std::fabs(a.y), std::fabs(b.x), std::fabs(b.y),
+								  std::fabs(c.x), std::fabs(c.y) }) * std::numeric_limits<float>::epsilon();
+	if (shortest < (cMinRefineEdgeUlps * ulp) * (cMinRefineEdgeUlps * ulp))
+	{
+		return 0;
+	}
+	// The smallest angle lies opposite the shortest edge, between two segments it is
+	// an input angle no new point can widen
+	const HalfEdge* shortestHE = shortest == ab ? he : (shortest == bc ? he->next() : he->prev());
+	if (isSegment(*shortestHE->next()) && isSegment(*shortestHE->prev()))
+	{
+		return area / mMaxArea;
+	}
+	// R = |ab| |bc| |ca| / (4 area)
+	const double ratioSq = ab * bc * ca / (16 * area * area * shortest);
+	return std::max(ratioSq / mMaxRatioSq, area / mMaxArea);
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::queueBadTriangle(size_t fid)
+{
+	const double faceBadness = badness(fid);
+	if (faceBadness > 1)
+	{
+		const HalfEdge* he = mMesh.heFromFace(fid);
+		std::array<size_t, 3> vids{ he->vid, he->next()->vid, he->prev()->vid };
+		std::sort(vids.begin(), vids.end());
+		mBadTriangles.push({ faceBadness, fid, vids });
+	}
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::queueSubsegment(const HalfEdge& he)
+{
+	mEncroached.push_back({ mMesh.heIndex(&he), he.vid, he.next()->vid });
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::checkStar(size_t pid)
+{
+	HalfEdge* first = firstOutgoing(pid);
+	HalfEdge* he = first;
+	while (true)
+	{
+		queueBadTriangle(he->fid);
+		const HalfEdge* edge = he;
+		for (int i = 0; i < 3; i++, edge = edge->next())
+		{
+			if (isSegment(*edge) && encroaches(*edge, mPoints[edge->prev()->vid]))
+			{
+				queueSubsegment(*edge);
+			}
+		}
+
+		HalfEdge* incoming = he->prev();
+		if (incoming->isBoundary())
+		{
+			break;
+		}
+		he = incoming->flip();
+		if (he == first)
+		{
+			break;
+		}
+	}
+}
+
+template <typename MeshType>
+size_t DelaunayTriangulationT<MeshType>::walkTowards(size_t fid, const Vector2f& p, size_t& outBlockingEdge, bool crossConstraints)
+{
+	const HalfEdge* curHE = mMesh.heFromFace(fid);
+	const HalfEdge* entryHE = nullptr;
+
+	while (true)
+	{
+		for (size_t i = mWalkRand() % 3; i > 0; i--)
+		{
+			curHE = curHE->next();
+		}
+
+		const HalfEdge* exitHE = nullptr;
+		for (int i = 0; i < 3; i++, curHE = curHE->next())
+		{
+			if (curHE != entryHE &&
+				Predicates::orient2d(mPoints[curHE->vid], mPoints[curHE->next()->vid], p) < 0)
+			{
+				exitHE = curHE;
+				break;
+			}
+		}
+
+		if (exitHE == nullptr)
+		{
+			return curHE->fid;
+		}
+		if (exitHE->isBoundary() || (!crossConstraints && isConstrained(*exitHE)))
+		{
+			outBlockingEdge = mMesh.heIndex(exitHE);
+			return cInvalidIndex;
+		}
+		entryHE = exitHE->flip();
+		curHE = entryHE;
+	}
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::collectEncroached(size_t fid, const Vector2f& p)
+{
+	// Faces whose circumcircle holds p, reached without crossing segments
+	mInCavity.resize(mMesh.faces.size(), 0);
+	mCavity.assign(1, fid);
+	mInCavity[fid] = 1;
+	for (size_t i = 0; i < mCavity.size(); i++)
+	{
+		const HalfEdge* he = mMesh.heFromFace(mCavity[i]);
+		for (int j = 0; j < 3; j++, he = he->next())
+		{
+			if (isSegment(*he))
+			{
+				if (encroaches(*he, p))
+				{
+					mCavitySegments.push_back({ mMesh.heIndex(he), he->vid, he->next()->vid });
+				}
+				continue;
+			}
+			const HalfEdge* hef = he->flip();
+			if (!mInCavity[hef->fid]
+				&& Utils::inCircle(mPoints[hef->vid], mPoints[hef->next()->vid], mPoints[hef->prev()->vid], p))
+			{
+				mCavity.push_back(hef->fid);
+				mInCavity[hef->fid] = 1;
+			}
+		}
+	}
+	for (size_t cavityFid : mCavity)
+	{
+		mInCavity[cavityFid] = 0;
+	}
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::splitSubsegment(const Subsegment& segment)
+{
+	const HalfEdge& he = mMesh.halfedges[segment.heId];
+	if (he.isInvalid() || !isSegment(he) || he.vid != segment.vid0 || he.next()->vid != segment.vid1)
+	{
+		return false;
+	}
+	// Segments with one input end point are split on concentric shells, at a power of two
+	// from it, so splits on segments meeting at a small angle stop encroaching upon each other
+	Vector2f a = mPoints[segment.vid0];
+	Vector2f b = mPoints[segment.vid1];
+	double t = 0.5;
+	if ((segment.vid0 < mInputPointCount) != (segment.vid1 < mInputPointCount))
+	{
+		if (segment.vid1 < mInputPointCount)
+		{
+			std::swap(a, b);
+		}
+		const double length = std::sqrt(lengthSq(a, b));
+		const double shell = std::exp2(std::round(std::log2(length * 0.5)));
+		t = shell / length;
+	}
+	const Vector2f mid(static_cast<float>(a.x + (double(b.x) - a.x) * t),
+					   static_cast<float>(a.y + (double(b.y) - a.y) * t));
+
+	// Rounding may not leave room next to very short segments
+	auto splits = [&](const HalfEdge& side)
+	{
+		const Vector2f from = mPoints[side.vid];
+		const Vector2f to = mPoints[side.next()->vid];
+		const Vector2f apex = mPoints[side.prev()->vid];
+		return Predicates::orient2d(from, mid, apex) > 0 && Predicates::orient2d(mid, to, apex) > 0;
+	};
+	if (!splits(he) || (!he.isBoundary() && !splits(*he.flip())))
+	{
+		return false;
+	}
+	const size_t pid = addPoint(mid);
+	insertAtEdge(pid, segment.heId);
+	checkStar(pid);
+	return true;
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::initUpdates()
+{
+	if (mVertexEdge.empty())
+	{
+		initConstraints();
+	}
+	if (mLocation == PointLocation::Bucketing)
+	{
+		// Every bucket is empty by now, new points are located by walking
+		mLocation = PointLocation::Walk;
+		std::vector<size_t>().swap(mBucketHead);
+		std::vector<size_t>().swap(mBucketNext);
+		std::vector<size_t>().swap(mVertexToBucketMap);
+	}
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::removePoint(size_t pid)
+{
+	if (pid >= mPoints.size() || mMesh.faces.empty())
+	{
+		return false;
+	}
+	initUpdates();
+	HalfEdge* first = firstOutgoing(pid);
+	if (first == nullptr)
+	{
+		return false;
+	}
+	const bool onHull = first->isBoundary();
+
+	// Spokes counter-clockwise, the hull adds the end of the last one
+	mEars.clear();
+	HalfEdge* he = first;
+	while (true)
+	{
+		if (isConstrained(*he))
+		{
+			return false;
+		}
+		mEars.push_back({ he, he->next()->vid, -std::numeric_limits<double>::infinity() });
+		HalfEdge* incoming = he->prev();
+		if (incoming->isBoundary())
+		{
+			if (isConstrained(*incoming))
+			{
+				return false;
+			}
+			mEars.push_back({ nullptr, incoming->vid, -std::numeric_limits<double>::infinity() });
+			break;
+		}
+		he = incoming->flip();
+		if (he == first)
+		{
+			break;
+		}
+	}
+
+	// Clip the ear whose circumcircle leaves pid the least power, which is Delaunay
+	// among the link, until only the faces to drop are left
+	mDirtyEdges.clear();
+	for (size_t i = 0; i < mEars.size(); i++)
+	{
+		updateEarPriority(i, pid, onHull);
+	}
+	const size_t finalCount = onHull ? 2 : 3;
+	while (mEars.size() > finalCount)
+	{
+		size_t best = 0;
+		for (size_t i = 1; i < mEars.size(); i++)
+		{
+			if (mEars[i].priority > mEars[best].priority)
+			{
+				best = i;
+			}
+		}
+		if (mEars[best].priority == -std::numeric_limits<double>::infinity())
+		{
+			break;
+		}
+		// The spoke becomes the edge between the neighbours, the other spokes stay
+		HalfEdge* spoke = mEars[best].spoke;
+		flipEdge(*spoke, *spoke->flip());
+		mDirtyEdges.push_back(spoke);
+		mEars.erase(mEars.begin() + best);
+		const size_t prevIdx = best > 0 ? best - 1 : mEars.size() - 1;
+		updateEarPriority(prevIdx, pid, onHull);
+		updateEarPriority(best < mEars.size() ? best : 0, pid, onHull);
+	}
+
+	// Faces left around pid, their link edges survive if another face is behind them
+	const size_t faceCount = onHull ? mEars.size() - 1 : mEars.size();
+	bool keepsFace = !onHull;
+	for (size_t i = 0; i < faceCount && !keepsFace; i++)
+	{
+		keepsFace = !mEars[i].spoke->next()->isBoundary();
+	}
+	if ((!onHull && mEars.size() != 3) || !keepsFace)
+	{
+		// Degenerate stars keep pid, the flips so far are undone where not Delaunay
+		restoreDelaunay(mDirtyEdges);
+		return false;
+	}
+
+	if (onHull)
+	{
+		// The edges facing pid become the hull
+		for (size_t i = 0; i < faceCount; i++)
+		{
+			HalfEdge* spoke = mEars[i].spoke;
+			HalfEdge* link = spoke->next();
+			HalfEdge* incoming = spoke->prev();
+			HalfEdge* outside = nullptr;
+			if (!link->isBoundary())
+			{
+				outside = link->flip();
+				link->breakFlip();
+				mDirtyEdges.push_back(outside);
+			}
+			if (!incoming->isBoundary())
+			{
+				incoming->breakFlip();
+			}
+			mMesh.release(mMesh.faces[spoke->fid]);
+			releaseHalfEdge(*spoke);
+			releaseHalfEdge(*link);
+			releaseHalfEdge(*incoming);
+			if (outside != nullptr)
+			{
+				mVertexEdge[outside->vid] = mMesh.heIndex(outside);
+				mVertexEdge[outside->next()->vid] = mMesh.heIndex(outside->next());
+				mLastFaceId = outside->fid;
+			}
+		}
+		// A link point without faces left has dropped out of the mesh as well
+		for (const Ear& ear : mEars)
+		{
+			const size_t heId = mVertexEdge[ear.vid];
+			if (heId != cInvalidIndex && mMesh.halfedges[heId].isInvalid())
+			{
+				mVertexEdge[ear.vid] = cInvalidIndex;
+			}
+		}
+	}
+	else
+	{
+		// The first face takes over the link of all three
+		HalfEdge* spokes[3];
+		HalfEdge* links[3];
+		HalfEdge* incomings[3];
+		for (int i = 0; i < 3; i++)
+		{
+			spokes[i] = mEars[i].spoke;
+			links[i] = spokes[i]->next();
+			incomings[i] = spokes[i]->prev();
+		}
+		Face& face = mMesh.faces[spokes[0]->fid];
+		mMesh.release(mMesh.faces[spokes[1]->fid]);
+		mMesh.release(mMesh.faces[spokes[2]->fid]);
+		mMesh.constructFace(*links[0], *links[1], *links[2], face);
+		for (int i = 0; i < 3; i++)
+		{
+			releaseHalfEdge(*spokes[i]);
+			releaseHalfEdge(*incomings[i]);
+			mVertexEdge[links[i]->vid] = mMesh.heIndex(links[i]);
+			mDirtyEdges.push_back(links[i]);
+		}
+		mLastFaceId = mMesh.faceIndex(&face);
+	}
+	mVertexEdge[pid] = cInvalidIndex;
+
+	restoreDelaunay(mDirtyEdges);
+	return true;
+}
+
+template <typename MeshType>
+double DelaunayTriangulationT<MeshType>::earPriority(size_t q0, size_t q1, size_t q2, size_t pid) const
+{
+	const Vector2f a = mPoints[q0];
+	const Vector2f b = mPoints[q1];
+	const Vector2f c = mPoints[q2];
+	const Vector2f p = mPoints[pid];
+	// Reflex corners and ones holding pid cannot be clipped, pid may lie on the new edge,
+	// the face without area that leaves goes with pid
+	const double area = Predicates::orient2d(a, b, c);
+	if (area <= 0 || Predicates::orient2d(a, c, p) < 0)
+	{
+		return -std::numeric_limits<double>::infinity();
+	}
+	// The in-circle determinant is the orientation times the negated power
+	return Predicates::inCircle(a, b, c, p) / area;
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::updateEarPriority(size_t earIdx, size_t pid, bool onHull)
+{
+	Ear& ear = mEars[earIdx];
+	const size_t count = mEars.size();
+	// The outer spokes of a hull point are hull edges
+	if (onHull && (earIdx == 0 || earIdx + 1 == count))
+	{
+		ear.priority = -std::numeric_limits<double>::infinity();
+		return;
+	}
+	const size_t prevVid = mEars[earIdx > 0 ? earIdx - 1 : count - 1].vid;
+	const size_t nextVid = mEars[earIdx + 1 < count ? earIdx + 1 : 0].vid;
+	ear.priority = earPriority(prevVid, ear.vid, nextVid, pid);
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::releaseHalfEdge(HalfEdge& he)
+{
+	mConstrained[mMesh.heIndex(&he)] = 0;
+	mMesh.release(he);
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::movePoint(size_t pid, const Vector2f& p)
+{
+	if (pid >= mPoints.size() || mMesh.faces.empty())
+	{
+		return false;
+	}
+	initUpdates();
+	HalfEdge* first = firstOutgoing(pid);
+	if (first == nullptr)
+	{
+		const Vector2f old = mPoints[pid];
+		mPoints.set(pid, p);
+		if (reinsertPoint(pid, cInvalidIndex))
+		{
+			return true;
+		}
+		mPoints.set(pid, old);
+		return false;
+	}
+
+	if (!first->isBoundary())
+	{
+		// Inside the kernel of its star pid keeps every face turned the right way
+		bool inStar = true;
+		mDirtyEdges.clear();
+		HalfEdge* he = first;
+		do
+		{
+			if (isConstrained(*he))
+			{
+				return false;
+			}
+			const HalfEdge* link = he->next();
+			inStar = inStar
+				&& Predicates::orient2d(mPoints[link->vid], mPoints[link->next()->vid], p) > 0;
+			mDirtyEdges.push_back(he);
+			mDirtyEdges.push_back(he->next());
+			he = he->prev()->flip();
+		} while (he != first);
+
+		if (inStar)
+		{
+			mPoints.set(pid, p);
+			restoreDelaunay(mDirtyEdges);
+			return true;
+		}
+	}
+
+	const Vector2f old = mPoints[pid];
+	const size_t nearPid = first->next()->vid;
+	if (!removePoint(pid))
+	{
+		return false;
+	}
+	mPoints.set(pid, p);
+	if (reinsertPoint(pid, nearPid))
+	{
+		return true;
+	}
+	// The old position is free again
+	mPoints.set(pid, old);
+	reinsertPoint(pid, nearPid);
+	return false;
+}
+
+template <typename MeshType>
+bool DelaunayTriangulationT<MeshType>::reinsertPoint(size_t pid, size_t nearPid)
+{
+	size_t fid = cInvalidIndex;
+	if (nearPid != cInvalidIndex && mVertexEdge[nearPid] != cInvalidIndex)
+	{
+		fid = mMesh.halfedges[mVertexEdge[nearPid]].fid;
+	}
+	else
+	{
+		for (size_t i = 0; i < mMesh.faces.size() && fid == cInvalidIndex; i++)
+		{
+			fid = mMesh.faces[i].isInvalid() ? cInvalidIndex : i;
+		}
+	}
+	if (fid == cInvalidIndex)
+	{
+		return false;
+	}
+
+	const Vector2f p = mPoints[pid];
+	size_t boundaryEdge = cInvalidIndex;
+	fid = walkTowards(fid, p, boundaryEdge, true);
+	if (fid == cInvalidIndex)
+	{
+		insertOutsideHull(pid, boundaryEdge);
+		return true;
+	}
+	size_t vertexId;
+	const size_t edgeId = onEdge(pid, fid, vertexId);
+	// A point on a constrained edge would split it for good, it could never leave again
+	if (vertexId != cInvalidIndex || (edgeId != cInvalidIndex && isConstrained(mMesh.halfedges[edgeId])))
+	{
+		return false;
+	}
+	if (edgeId == cInvalidIndex)
+	{
+		insertIntoFace(pid, fid);
+	}
+	else
+	{
+		insertAtEdge(pid, edgeId);
+	}
+	return true;
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::insertOutsideHull(size_t pid, size_t boundaryEdgeId)
+{
+	const Vector2f p = mPoints[pid];
+	auto visible = [&](const HalfEdge* he)
+	{
+		return Predicates::orient2d(mPoints[he->vid], mPoints[he->next()->vid], p) < 0;
+	};
+	// Hull edges before and after he, around its start and its end
+	auto prevHullEdge = [](HalfEdge* he)
+	{
+		HalfEdge* incoming = he->prev();
+		while (!incoming->isBoundary())
+		{
+			incoming = incoming->flip()->prev();
+		}
+		return incoming;
+	};
+	auto nextHullEdge = [](HalfEdge* he)
+	{
+		HalfEdge* outgoing = he->next();
+		while (!outgoing->isBoundary())
+		{
+			outgoing = outgoing->flip()->next();
+		}
+		return outgoing;
+	};
+
+	// Hull edges seen from p form one chain, in hull order
+	HalfEdge* firstHE = &mMesh.halfedges[boundaryEdgeId];
+	while (visible(prevHullEdge(firstHE)))
+	{
+		firstHE = prevHullEdge(firstHE);
+	}
+	std::vector<size_t> chain{ mMesh.heIndex(firstHE) };
+	for (HalfEdge* he = nextHullEdge(firstHE); visible(he); he = nextHullEdge(he))
+	{
+		chain.push_back(mMesh.heIndex(he));
+	}
+
+	// A face on every edge, the new edges into p pair up between neighbours
+	std::vector<HalfEdge*> frontierEdges(chain.size());
+	size_t prevFromPid = cInvalidIndex;
+	for (size_t i = 0; i < chain.size(); i++)
+	{
+		Face* newFace[1];
+		HalfEdge* newHE[3];
+		mMesh.allocate(3, newHE, 1, newFace);
+		HalfEdge& hull = mMesh.halfedges[chain[i]];
+		newHE[0]->vid = hull.next()->vid;
+		newHE[1]->vid = hull.vid;
+		newHE[2]->vid = static_cast<typename Mesh::Index>(pid);
+		mMesh.constructFace(*newHE[0], *newHE[1], *newHE[2], *newFace[0]);
+		newHE[0]->setFlip(&hull);
+		if (prevFromPid != cInvalidIndex)
+		{
+			newHE[1]->setFlip(&mMesh.halfedges[prevFromPid]);
+		}
+		prevFromPid = mMesh.heIndex(newHE[2]);
+		chain[i] = mMesh.heIndex(newHE[0]);
+	}
+	mConstrained.resize(mMesh.halfedges.size(), 0);
+	for (size_t i = 0; i < chain.size(); i++)
+	{
+		// A constrained hull edge gets its other half, both halves carry the flag
+		frontierEdges[i] = &mMesh.halfedges[chain[i]];
+		if (isConstrained(*frontierEdges[i]->flip()))
+		{
+			markConstrained(*frontierEdges[i]);
+		}
+	}
+	mVertexEdge[pid] = mMesh.heIndex(frontierEdges[0]->prev());
+	mLastFaceId = frontierEdges[0]->fid;
+
+	legalizeEdge(frontierEdges, pid);
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::initInsertionOrder(InsertionOrder order)
+{
+	if (order == InsertionOrder::BiasedRandomized)
+	{
+		Utils::brioOrder(mPoints, mInsertionOrder);
+	}
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::insertPoint(size_t pointId)
+{
+	size_t faceId;
+	if (mLocation == PointLocation::Bucketing)
+	{
+		faceId = mVertexToBucketMap[pointId];
+		// Mark as inserted, re-bucketing drops it from its face
+		mVertexToBucketMap[pointId] = cInvalidIndex;
+	}
+	else
+	{
+		faceId = locateFace(pointId);
+	}
+	// A point repeating a vertex lies in one of its faces, inserting it would split
+	// the face into ones without area
+	size_t vertexId;
+	size_t edgeId = onEdge(pointId, faceId, vertexId);
+	if (vertexId != cInvalidIndex)
+	{
+		mDuplicates.emplace_back(pointId, vertexId);
+		return;
+	}
+	if (edgeId == cInvalidIndex)
+	{
+		// Insert into face
+		insertIntoFace(pointId, faceId);
+	}
+	else
+	{
+		// Insert on edge
+		insertAtEdge(pointId, edgeId);
+	}
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::traversalPts()
+{
+	size_t skipPtId = mMesh.halfedges[2].vid;
+	if (mInsertionOrder.empty())
+	{
+		for (size_t pointId = 0; pointId < mPoints.size(); pointId++)
+		{
+			if (pointId != skipPtId)
+			{
+				insertPoint(pointId);
+			}
+		}
+	}
+	else
+	{
+		for (size_t pointId : mInsertionOrder)
+		{
+			if (pointId != skipPtId)
+			{
+				insertPoint(pointId);
+			}
+		}
+	}
+}
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::finalizeHDS()
+{
+	for (HalfEdge& he : mMesh.halfedges)
+	{
+		if (he.vid >= cVertexIdNegTwo && !he.isInvalid())
+		{
+			HalfEdge* curHE = &he;
+			mMesh.faces[he.fid].setToInvalid();
+			do
+			{
+				HalfEdge* nextHE = curHE->next();
+				curHE->setToInvalid();
+				curHE->breakFlip();
+				curHE = nextHE;
+			} while (curHE != &he);
+		}
+	}
+}
+
+/*
+bool Delaunay::keepInsertion()
+{
+	if (mUnusedPtIds.empty())
+	{
+		return false;
+	}
+	size_t pointId = mUnusedPtIds.top();
+
+	size_t faceId = mVertexToBucketMap[pointId];
+	size_t edgeId = onEdge(pointId, faceId);
+	if (edgeId == cInvalidIndex)
+	{
+		// Insert into face
+		insertIntoFace(pointId, faceId);
+	}
+	else
+	{
+		// Insert on edge
+		insertAtEdge(pointId, edgeId);
+	}
+
+	mUnusedPtIds.pop();
+	return true;
+}*/
+
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::extractConstraintIndices(std::vector<uint32_t>& outIndices) const
+{
+	outIndices.clear();
+	for (size_t heId = 0; heId < mConstrained.size(); heId++)
+	{
+		const HalfEdge& he = mMesh.halfedges[heId];
+		// Each edge once, from the half-edge with the smaller index
+		if (mConstrained[heId] && !he.isInvalid()
+			&& (he.isBoundary() || heId < mMesh.heIndex(he.flip())))
+		{
+			outIndices.push_back(static_cast<uint32_t>(he.vid));
+			outIndices.push_back(static_cast<uint32_t>(he.next()->vid));
+		}
+	}
+}
 
-void DelaunayTriangulation::extractTriangleIndices(std::vector<uint32_t>& outIndices) const
+template <typename MeshType>
+void DelaunayTriangulationT<MeshType>::extractTriangleIndices(std::vector<uint32_t>& outIndices) const
 {
-	for (auto& f : mMesh.faces)
+	for (size_t fid = 0; fid < mMesh.faces.size(); fid++)
 	{
-		if (f.isInvalid())
+		if (mMesh.faces[fid].isInvalid())
 		{
 			continue;
 		}
 
-		const HDS::HalfEdge* he = mMesh.heFromFace(f.index);
-		const HDS::HalfEdge* curHE = he;
+		const HalfEdge* he = mMesh.heFromFace(fid);
+		const HalfEdge* curHE = he;
 
 		std::array<uint32_t, 3> vids;
 		size_t localVidIdx = 0;
@@ -434,3 +1752,5 @@ void DelaunayTriangulation::extractTriangleIndices(std::vector<uint32_t>& outInd
 	}
 }
 
+template class DelaunayTriangulationT<HDS::Mesh>;
+template class DelaunayTriangulationT<HDS::CompactMesh>;
@@ -1,30 +1,136 @@
 #pragma once
 #include "common.h"
 #include "Vector2.h"
+#include "PointSet.h"
 #include "HalfEdge.h"
 
-class DelaunayTriangulation
+// Templated on the mesh, HDS::CompactMesh halves the memory of HDS::Mesh for inputs within its range
+template <typename MeshType>
+class DelaunayTriangulationT
 {
 public:
-	DelaunayTriangulation(std::vector<Vector2f>& inPoints);
-	~DelaunayTriangulation();
+	using Mesh = MeshType;
+	using HalfEdge = typename Mesh::HalfEdge;
+	using Face = typename Mesh::Face;
+
+	// Order in which points are inserted into the triangulation
+	enum class InsertionOrder
+	{
+		Input,				// Points are inserted as given
+		BiasedRandomized	// BRIO rounds sorted along Hilbert curve
+	};
+
+	// How the face containing the next point is found
+	enum class PointLocation
+	{
+		Bucketing,	// Conflict lists of uninserted points per face
+		Walk		// Remembering stochastic walk from the last inserted face
+	};
+
+	// More than maxMeshPointCount points leave the triangulation empty
+	DelaunayTriangulationT(PointSet&& inPoints,
+						   InsertionOrder order = InsertionOrder::Input,
+						   PointLocation location = PointLocation::Bucketing);
+	DelaunayTriangulationT(std::vector<Vector2f>& inPoints,
+						   InsertionOrder order = InsertionOrder::Input,
+						   PointLocation location = PointLocation::Bucketing);
+	DelaunayTriangulationT(Vector2SoA& inPoints,
+						   InsertionOrder order = InsertionOrder::Input,
+						   PointLocation location = PointLocation::Bucketing);
+	~DelaunayTriangulationT();
+
+	// Most points the mesh can index, input and refined together,
+	// a triangulation of n points holds up to 6n half-edges
+	static size_t maxMeshPointCount()
+	{
+		return static_cast<size_t>(std::numeric_limits<typename HalfEdge::Offset>::max()) / 6;
+	}
 
 	void extractTriangleIndices(std::vector<uint32_t>& outIndices) const;
+	// Two point ids per constrained edge
+	void extractConstraintIndices(std::vector<uint32_t>& outIndices) const;
+
+	// Forces the segment between two points into the triangulation and marks it constrained,
+	// so no later flip removes it, the other edges are kept Delaunay where the constraints allow
+	// A segment through other points is split at them
+	// Returns false if the segment crosses a constrained edge or runs through faces without area,
+	// the parts before stay inserted
+	bool insertConstraint(size_t pid0, size_t pid1);
+
+	// Inserts the circumcenters of triangles with an angle below minAngle degrees or an area
+	// above maxArea, worst first, while no segment is in the way (Ruppert)
+	// Constrained and hull edges whose diametral circle would hold a new point are split
+	// instead, at the midpoint or a power of two from an input end point,
+	// so the mesh keeps to the input domain
+	// Angles between two segments and edges near float resolution are left as they are
+	// Bounds above 20.7 degrees or input angles below 60 may refine forever,
+	// maxPointCount caps the points added, as does maxMeshPointCount, returns how many were
+	size_t refine(float minAngle,
+				  float maxArea = std::numeric_limits<float>::infinity(),
+				  size_t maxPointCount = cInvalidIndex);
+
+	// Takes a point out of the triangulation, the spokes of its best ears are flipped away
+	// until its star is down to three faces, which merge into one (Devillers)
+	// A point on the hull takes its faces with it once no ear is left, the hull stays convex
+	// Points on constrained edges stay, as do points whose star has no ear left,
+	// returns false then
+	// The id stays valid, movePoint puts the point back, and the freed half-edges and faces
+	// are reused by the next insertions
+	bool removePoint(size_t pid);
+	// Moves a point, which stays in the same faces while it is inside its star, the edges
+	// around it are flipped back to Delaunay, else it is removed and inserted again
+	// A removed point is inserted at p
+	// Returns false and leaves the point where it was if it is on a constrained edge,
+	// or p is taken by another point or lies on a constrained edge, which it would split for good
+	bool movePoint(size_t pid, const Vector2f& p);
+
+	// Input points followed by the ones added by refine
+	const PointSet& points() const { return mPoints; }
+	// Input points left out because they repeat an earlier one, with the vertex they repeat
+	const std::vector<std::pair<size_t, size_t>>& duplicatePoints() const { return mDuplicates; }
 
 private:
+	// Face waiting for refinement, stale once it holds other vertices
+	struct BadTriangle
+	{
+		double badness;
+		size_t fid;
+		// Sorted, faces are relinked from any of their half-edges
+		std::array<size_t, 3> vids;
+
+		bool operator<(const BadTriangle& other) const { return badness < other.badness; }
+	};
+	// Constrained or hull edge waiting to be split, stale once its end points changed
+	struct Subsegment
+	{
+		size_t heId;
+		size_t vid0, vid1;
+	};
+	// Corner of the star of a point being removed, clipped by flipping its spoke away
+	struct Ear
+	{
+		// Outgoing edge of the removed point, nullptr past the last one on the hull
+		HalfEdge* spoke;
+		size_t vid;
+		// Negative infinity when the ear cannot be clipped
+		double priority;
+	};
+
 	void initFirstTriangle();
 	void initBucket();
 
 	void reBucketPoint(size_t vid, size_t fid);
+	// Unlink the whole bucket of a face, returns head of the detached list
+	size_t detachBucket(size_t fid);
 	// re-bucket when flipping edge
-	void reBucketFlip(const HDS::HalfEdge& he/*, const HDS_HalfEdge& hef*/);
+	void reBucketFlip(const HalfEdge& he/*, const HDS_HalfEdge& hef*/);
 	// re-bucket when split by new edge
 	// TODO: Rmove this use above
-	void reBucketStarSplit(/*const size_t oriFid,*/ const HDS::HalfEdge& he0, const HDS::HalfEdge& he1, const HDS::HalfEdge& he2);
+	void reBucketStarSplit(/*const size_t oriFid,*/ const HalfEdge& he0, const HalfEdge& he1, const HalfEdge& he2);
 	//void reBucketSplit(const size_t fid, const HDS_HalfEdge& splitHE);
 
-	// Returns heId if on edge
-	size_t onEdge(size_t ptId, size_t fid);
+	// Returns heId if on edge, outVertexId is the vertex if the point is collinear with both its edges
+	size_t onEdge(size_t ptId, size_t fid, size_t& outVertexId);
 
 	// Origin Point v0 must NOT be infinite points
 	// P is to the left of vector v0-v1
@@ -32,17 +138,75 @@ private:
 	//     v0 *--------->* v1
 	bool toLeft(size_t vId0, size_t vId1, size_t pId);
 	bool toRight(size_t oriVid, size_t targVid, size_t curVid);
+	// P is strictly to the right of edge v0-v1, either vertex may be infinite
+	bool outsideEdge(size_t vId0, size_t vId1, size_t pId);
+
+	// Walk from the last inserted face towards the face containing ptId
+	size_t locateFace(size_t ptId);
 
 	bool inCircle(size_t triP0, size_t triP1, size_t triP2, size_t targ);
 
-	void flipEdge(HDS::HalfEdge& he, HDS::HalfEdge& hef);
+	void flipEdge(HalfEdge& he, HalfEdge& hef);
+	// Both diagonals of the quad around an inner edge separate its other two corners
+	bool convexQuad(const HalfEdge& he) const;
+	// Lawson flips from the given edges until all of them and the ones flipped around them are Delaunay
+	void restoreDelaunay(std::vector<HalfEdge*>& dirtyEdges);
+
+	bool isConstrained(const HalfEdge& he) const
+	{
+		return !mConstrained.empty() && mConstrained[mMesh.heIndex(&he)];
+	}
+	void markConstrained(HalfEdge& he);
+	void initConstraints();
+	// Edge out of fromPid along the segment to toPid if there is one, outNextPid is then its end,
+	// else the edge opposite fromPid in the face the segment leaves through
+	HalfEdge* segmentStart(size_t fromPid, size_t toPid, size_t& outNextPid);
+	// Flips the edges crossing the segment out of the way, starting with firstCrossing,
+	// returns the end of the recovered edge, cInvalidIndex if blocked by a constraint
+	size_t recoverSegment(size_t fromPid, size_t toPid, HalfEdge* firstCrossing);
 
 	void insertIntoFace(size_t ptId, size_t fid);
 	void insertAtEdge(size_t ptId, size_t edgeId);
+	void insertAtBoundaryEdge(size_t ptId, size_t edgeId);
+
+	// Outgoing half-edge of pid from which a counter-clockwise sweep passes all its faces
+	HalfEdge* firstOutgoing(size_t pid);
+	size_t addPoint(const Vector2f& p);
+
+	bool isSegment(const HalfEdge& he) const { return he.isBoundary() || isConstrained(he); }
+	// p lies inside the diametral circle of the edge
+	bool encroaches(const HalfEdge& he, const Vector2f& p) const;
+	// Above 1 when the face breaks the refinement bounds
+	double badness(size_t fid) const;
+	void queueBadTriangle(size_t fid);
+	void queueSubsegment(const HalfEdge& he);
+	// Queues the bad faces around pid and the segments their corners encroach upon
+	void checkStar(size_t pid);
+	// Walk from face fid towards p, returns the face containing p,
+	// or cInvalidIndex with outBlockingEdge set to the segment in the way,
+	// which is only ever a hull edge when crossing constraints
+	size_t walkTowards(size_t fid, const Vector2f& p, size_t& outBlockingEdge, bool crossConstraints = false);
+	// Collects the segments p encroaches upon in the cavity it would open around fid
+	void collectEncroached(size_t fid, const Vector2f& p);
+	bool splitSubsegment(const Subsegment& segment);
+
+	// Vertex to edge map and walking point location, for changes after construction
+	void initUpdates();
+	// Power of pid against the circumcircle of the ear q0 q1 q2, negated
+	double earPriority(size_t q0, size_t q1, size_t q2, size_t pid) const;
+	void updateEarPriority(size_t earIdx, size_t pid, bool onHull);
+	// Clears the constraint flag too, the slot is reused
+	void releaseHalfEdge(HalfEdge& he);
+	// Inserts a point that is not in the mesh, starting the walk next to nearPid
+	bool reinsertPoint(size_t pid, size_t nearPid);
+	// Connects pid to the hull edges it sees, the walk left the mesh through boundaryEdgeId
+	void insertOutsideHull(size_t pid, size_t boundaryEdgeId);
 
-	void legalizeEdge(std::vector<HDS::HalfEdge*>& frontierEdges, size_t insertedPtId);
+	void legalizeEdge(std::vector<HalfEdge*>& frontierEdges, size_t insertedPtId);
 	//void legalizeEdge(HDS_HalfEdge& dirtyEdge, size_t insertedPtId);
 
+	void initInsertionOrder(InsertionOrder order);
+	void insertPoint(size_t pointId);
 	void traversalPts();
 	//bool keepInsertion();
 
@@ -52,18 +216,58 @@ private:
 private:
 	// Structure to store vertex position
 	// aka the triangle face id where the vertex belongs
-	unordered_map<size_t, std::vector<size_t>> mBucket;// Face to Pt
-	std::vector<size_t> mVertexToBucketMap;// Pt to Face
+	// Buckets are intrusive singly linked lists threaded through mBucketNext,
+	// so re-bucketing never allocates
+	std::vector<size_t> mBucketHead;// Face to first Pt
+	std::vector<size_t> mBucketNext;// Pt to next Pt in the same face
+	std::vector<size_t> mVertexToBucketMap;// Pt to Face, invalid once inserted
 
 	// Vertex positions
-	std::vector<Vector2f> mPoints;
+	PointSet mPoints;
+	// Points past it were added by refine
+	size_t mInputPointCount;
+	// Point ids in insertion order, empty when inserting in input order
+	std::vector<size_t> mInsertionOrder;
+	// Skipped point and the vertex at its position
+	std::vector<std::pair<size_t, size_t>> mDuplicates;
+
+	PointLocation mLocation;
+	// Start face of the next walk
+	size_t mLastFaceId;
+	std::minstd_rand mWalkRand;
 
 	// Triangle mesh represented by HalfEdge Data Structure to maintain mesh traversal
-	HDS::Mesh mMesh;
+	Mesh mMesh;
+
+	// Flag per half-edge, kept beside the mesh so the half-edges stay compact
+	// Empty until the first constraint, like the vertex to outgoing half-edge map
+	std::vector<uint8_t> mConstrained;
+	std::vector<size_t> mVertexEdge;
+	// Edges crossing the segment being recovered and the edges flipped into its place
+	std::vector<HalfEdge*> mCrossedEdges;
+	std::vector<HalfEdge*> mNewEdges;
+
+	// Refinement bounds and queues, segments are split before any circumcenter goes in
+	double mMaxRatioSq;
+	double mMaxArea;
+	std::priority_queue<BadTriangle> mBadTriangles;
+	std::vector<Subsegment> mEncroached;
+	// Faces of the cavity of a circumcenter and the segments it encroaches upon
+	std::vector<size_t> mCavity;
+	std::vector<uint8_t> mInCavity;
+	std::vector<Subsegment> mCavitySegments;
+
+	// Star of the point being removed and the edges to check once it is retriangulated
+	std::vector<Ear> mEars;
+	std::vector<HalfEdge*> mDirtyEdges;
 
 	//std::stack<size_t> mUnusedPtIds;
 
-	const static size_t cVertexIdNegOne = static_cast<size_t>(-1);
-	const static size_t cVertexIdNegTwo = static_cast<size_t>(-2);
+	// Largest ids of the mesh index type, so they survive the round trip through HalfEdge::vid
+	const static size_t cVertexIdNegOne = static_cast<typename Mesh::Index>(-1);
+	const static size_t cVertexIdNegTwo = static_cast<typename Mesh::Index>(-2);
 };
 
+using DelaunayTriangulation = DelaunayTriangulationT<HDS::Mesh>;
+using CompactDelaunayTriangulation = DelaunayTriangulationT<HDS::CompactMesh>;
+
@@ -3,23 +3,13 @@
 namespace HDS
 {
 
-size_t Vertex::uid = 0;
-size_t HalfEdge::uid = 0;
-size_t Face::uid = 0;
-
-void Mesh::insertNewVertexOnEdge(HalfEdge*& outNewHE,
-								 Face*& outNewFace,
-								 size_t vId,
-								 size_t heId)
+template <typename IndexT>
+void MeshT<IndexT>::insertNewVertexOnEdge(HalfEdge** outNewHE,
+										  Face** outNewFace,
+										  size_t vId,
+										  size_t heId)
 {
-	size_t newHeId = halfedges.size();
-	size_t newFaceId = faces.size();
-
-	halfedges.resize(newHeId + 6);
-	faces.resize(newFaceId + 2);
-
-	outNewHE = &halfedges[newHeId];
-	outNewFace = &faces[newFaceId];
+	allocate(6, outNewHE, 2, outNewFace);
 
 	// Assume mesh is triangulated
 	HalfEdge& he = halfedges[heId];
@@ -30,58 +20,113 @@ void Mesh::insertNewVertexOnEdge(HalfEdge*& outNewHE,
 	HalfEdge& oriHe2 = *hef.next();
 	HalfEdge& oriHe3 = *oriHe2.next();
 
-	outNewHE[0].vid = oriHe1.vid;
-	outNewHE[2].vid = oriHe2.vid;
-	outNewHE[4].vid = oriHe3.vid;
+	outNewHE[0]->vid = oriHe1.vid;
+	outNewHE[2]->vid = oriHe2.vid;
+	outNewHE[4]->vid = oriHe3.vid;
 	// update he
-	he.vid = outNewHE[1].vid = outNewHE[3].vid = outNewHE[5].vid = vId;
+	he.vid = outNewHE[1]->vid = outNewHE[3]->vid = outNewHE[5]->vid = static_cast<IndexT>(vId);
 
-	outNewHE[0].setFlip(outNewHE + 1);
-	outNewHE[2].setFlip(outNewHE + 3);
-	outNewHE[4].setFlip(outNewHE + 5);
+	outNewHE[0]->setFlip(outNewHE[1]);
+	outNewHE[2]->setFlip(outNewHE[3]);
+	outNewHE[4]->setFlip(outNewHE[5]);
 
 	Face& face0 = faces[he.fid];
-	Face& face1 = faces[newFaceId];
-	Face& face2 = faces[newFaceId + 1];
 	Face& face3 = faces[hef.fid];
 
-	constructFace(oriHe0, outNewHE[0], he, face0);
-	constructFace(oriHe1, outNewHE[2], outNewHE[1], face1);
-	constructFace(oriHe2, outNewHE[4], outNewHE[3], face2);
-	constructFace(oriHe3, hef, outNewHE[5], face3);
+	constructFace(oriHe0, *outNewHE[0], he, face0);
+	constructFace(oriHe1, *outNewHE[2], *outNewHE[1], *outNewFace[0]);
+	constructFace(oriHe2, *outNewHE[4], *outNewHE[3], *outNewFace[1]);
+	constructFace(oriHe3, hef, *outNewHE[5], face3);
 }
 
-void Mesh::insertNewVertexInFace(HalfEdge*& outNewHE,
-								 Face*& outNewFace,
-								 size_t vId,
-								 size_t fId)
+template <typename IndexT>
+void MeshT<IndexT>::insertNewVertexOnBoundaryEdge(HalfEdge** outNewHE,
+												  Face** outNewFace,
+												  size_t vId,
+												  size_t heId)
 {
-	size_t newEdgeId = halfedges.size();
-	size_t newFaceId = faces.size();
+	allocate(3, outNewHE, 1, outNewFace);
+
+	HalfEdge& he = halfedges[heId];
+	HalfEdge& oriHe0 = *he.next();
+	HalfEdge& oriHe1 = *oriHe0.next();
+
+	// outNewHE[2] takes over the first half of the boundary
+	outNewHE[0]->vid = oriHe1.vid;
+	outNewHE[2]->vid = he.vid;
+	he.vid = outNewHE[1]->vid = static_cast<IndexT>(vId);
+
+	outNewHE[0]->setFlip(outNewHE[1]);
 
-	halfedges.resize(newEdgeId + 6);
-	faces.resize(newFaceId + 2);
+	Face& face0 = faces[he.fid];
+
+	constructFace(oriHe0, *outNewHE[0], he, face0);
+	constructFace(oriHe1, *outNewHE[2], *outNewHE[1], *outNewFace[0]);
+}
 
-	outNewHE = &halfedges[newEdgeId];
-	outNewFace = &faces[newFaceId];
+template <typename IndexT>
+void MeshT<IndexT>::insertNewVertexInFace(HalfEdge** outNewHE,
+										  Face** outNewFace,
+										  size_t vId,
+										  size_t fId)
+{
+	allocate(6, outNewHE, 2, outNewFace);
 
 	HalfEdge& oriHe0 = *heFromFace(fId);
 	HalfEdge& oriHe1 = *oriHe0.next();
 	HalfEdge& oriHe2 = *oriHe1.next();
 
 	// Link face loop
-	outNewHE[1].vid = oriHe1.vid;
-	outNewHE[3].vid = oriHe2.vid;
-	outNewHE[5].vid = oriHe0.vid;
-	outNewHE[0].vid = outNewHE[2].vid = outNewHE[4].vid = vId;
-
-	constructFace(oriHe0, outNewHE[1], outNewHE[0], faces[fId]);
-	constructFace(oriHe1, outNewHE[3], outNewHE[2], faces[newFaceId]);
-	constructFace(oriHe2, outNewHE[5], outNewHE[4], faces[newFaceId + 1]);
-
-	outNewHE[1].setFlip(outNewHE + 2);
-	outNewHE[3].setFlip(outNewHE + 4);
-	outNewHE[5].setFlip(outNewHE);
+	outNewHE[1]->vid = oriHe1.vid;
+	outNewHE[3]->vid = oriHe2.vid;
+	outNewHE[5]->vid = oriHe0.vid;
+	outNewHE[0]->vid = outNewHE[2]->vid = outNewHE[4]->vid = static_cast<IndexT>(vId);
+
+	constructFace(oriHe0, *outNewHE[1], *outNewHE[0], faces[fId]);
+	constructFace(oriHe1, *outNewHE[3], *outNewHE[2], *outNewFace[0]);
+	constructFace(oriHe2, *outNewHE[5], *outNewHE[4], *outNewFace[1]);
+
+	outNewHE[1]->setFlip(outNewHE[2]);
+	outNewHE[3]->setFlip(outNewHE[4]);
+	outNewHE[5]->setFlip(outNewHE[0]);
 }
 
+template <typename IndexT>
+void MeshT<IndexT>::allocate(SizeType heCount, HalfEdge** outHEs, SizeType faceCount, Face** outFaces)
+{
+	// Ids first, the pointers are taken once both arrays have their final size
+	IndexT heIds[6];
+	IndexT faceIds[2];
+
+	SizeType reused = std::min(heCount, freeHalfEdges.size());
+	SizeType newId = halfedges.size();
+	for (SizeType i = 0; i < heCount; i++)
+	{
+		heIds[i] = static_cast<IndexT>(i < reused ? freeHalfEdges[freeHalfEdges.size() - 1 - i] : newId++);
+	}
+	freeHalfEdges.resize(freeHalfEdges.size() - reused);
+	halfedges.resize(newId);
+
+	reused = std::min(faceCount, freeFaces.size());
+	newId = faces.size();
+	for (SizeType i = 0; i < faceCount; i++)
+	{
+		faceIds[i] = static_cast<IndexT>(i < reused ? freeFaces[freeFaces.size() - 1 - i] : newId++);
+	}
+	freeFaces.resize(freeFaces.size() - reused);
+	faces.resize(newId);
+
+	for (SizeType i = 0; i < heCount; i++)
+	{
+		outHEs[i] = &halfedges[heIds[i]];
+	}
+	for (SizeType i = 0; i < faceCount; i++)
+	{
+		outFaces[i] = &faces[faceIds[i]];
+	}
+}
+
+template class MeshT<SizeType>;
+template class MeshT<uint32_t>;
+
 }
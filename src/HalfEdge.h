@@ -9,57 +9,64 @@ static const SizeType cInvalidIndex = static_cast<SizeType>(-1);
 namespace HDS
 {
 
+// All mesh components are templated on the index type
+// size_t for the general mesh, uint32_t for the compact one
+// which halves the footprint of every half-edge and face
+// Components carry no global state, the index of each one is its position
+// in the owning mesh, so independent meshes can be built on separate threads
+
 // Vertex
-class Vertex
+template <typename IndexT>
+class VertexT
 {
 public:
-	Vertex() : index(uid++), pid(cInvalidIndex), heid(cInvalidIndex) {}
-	~Vertex() {}
+	static const IndexT cInvalid = static_cast<IndexT>(-1);
 
-	static void resetIndex() { uid = 0; }
+	VertexT() : pid(cInvalid), heid(cInvalid) {}
+	~VertexT() {}
 
-	SizeType pid;
-	SizeType index;
-	SizeType heid;
-private:
-	static SizeType uid;
+	IndexT pid;
+	IndexT heid;
 };
 
 
 // Half-Edge
-class HalfEdge
+// The index of a half-edge is its position in Mesh::halfedges,
+// use Mesh::heIndex to recover it from a pointer
+template <typename IndexT>
+class HalfEdgeT
 {
 public:
-	static void resetIndex() { uid = 0; }
-	static void matchIndexToSize(SizeType	size) { uid = size; }
+	using Offset = typename std::make_signed<IndexT>::type;
+	static const IndexT cInvalid = static_cast<IndexT>(-1);
 
-	HalfEdge() : index(uid++), fid(cInvalidIndex), vid(cInvalidIndex)
+	HalfEdgeT() : fid(cInvalid), vid(cInvalid)
 		, prev_offset(0), next_offset(0), flip_offset(0)
 	{
 	}
-	~HalfEdge() {}
+	~HalfEdgeT() {}
 
 	// Get the explicit pointer to corresponding edges
-	HalfEdge* prev() { return this + prev_offset; }
-	HalfEdge* next() { return this + next_offset; }
-	HalfEdge* flip() { return this + flip_offset; }
-	HalfEdge* rotCW() { return flip()->next(); }
-	HalfEdge* rotCCW() { return prev()->flip(); }
-	const HalfEdge* prev() const { return this + prev_offset; }
-	const HalfEdge* next() const { return this + next_offset; }
-	const HalfEdge* flip() const { return this + flip_offset; }
-	const HalfEdge* rotCW() const { return flip()->next(); }
-	const HalfEdge* rotCCW() const { return prev()->flip(); }
+	HalfEdgeT* prev() { return this + prev_offset; }
+	HalfEdgeT* next() { return this + next_offset; }
+	HalfEdgeT* flip() { return this + flip_offset; }
+	HalfEdgeT* rotCW() { return flip()->next(); }
+	HalfEdgeT* rotCCW() { return prev()->flip(); }
+	const HalfEdgeT* prev() const { return this + prev_offset; }
+	const HalfEdgeT* next() const { return this + next_offset; }
+	const HalfEdgeT* flip() const { return this + flip_offset; }
+	const HalfEdgeT* rotCW() const { return flip()->next(); }
+	const HalfEdgeT* rotCCW() const { return prev()->flip(); }
 
 	bool isBoundary() const { return flip_offset == 0; }
 
 	// No self-loop edge
-	void setToInvalid() { prev_offset = next_offset = 0; fid = cInvalidIndex; }
-	bool isInvalid() const { return prev_offset == 0 || next_offset == 0 || fid == cInvalidIndex; }
+	void setToInvalid() { prev_offset = next_offset = 0; fid = cInvalid; }
+	bool isInvalid() const { return prev_offset == 0 || next_offset == 0 || fid == cInvalid; }
 
-	void setFlip(HalfEdge* f_e)
+	void setFlip(HalfEdgeT* f_e)
 	{
-		flip_offset = f_e - this;
+		flip_offset = static_cast<Offset>(f_e - this);
 		f_e->flip_offset = -flip_offset;
 	}
 	void breakFlip()
@@ -68,68 +75,58 @@ public:
 	}
 
 	//////////////////////////////////////////////////////////////////////////
-	SizeType index;
-	SizeType fid;
-	SizeType vid;
+	IndexT fid;
+	IndexT vid;
 	// Offset to index of previous/next/flip edge
 	// previous/next/flip edge doesn't exist
 	// when (previous/nex/flip == 0)
-	OffsetType prev_offset, next_offset, flip_offset;
-
-private:
-
-	static SizeType uid;
+	Offset prev_offset, next_offset, flip_offset;
 };
 
 // Face
-class Face
+// The index of a face is its position in Mesh::faces, see Mesh::faceIndex
+template <typename IndexT>
+class FaceT
 {
 public:
-	static void resetIndex() { uid = 0; }
+	static const IndexT cInvalid = static_cast<IndexT>(-1);
 
-	Face() : index(uid++), heid(cInvalidIndex) {}
-	~Face() {}
+	FaceT() : heid(cInvalid) {}
+	~FaceT() {}
 
 	// Get the connected half-edge id
 	// Explicit pointer access is handled by HDS_Mesh
-	SizeType heID() const { return heid; }
+	IndexT heID() const { return heid; }
 
 
-	void setToInvalid() { heid = cInvalidIndex; }
-	bool isInvalid() const { return heid == cInvalidIndex; }
+	void setToInvalid() { heid = cInvalid; }
+	bool isInvalid() const { return heid == cInvalid; }
 
 	// Member data
-	SizeType index;
-	SizeType heid;
-
-private:
-	static SizeType uid;
+	IndexT heid;
 };
 
 // Mesh
-class Mesh
+template <typename IndexT>
+class MeshT
 {
 public:
-	Mesh() {}
+	using Index = IndexT;
+	using Vertex = VertexT<IndexT>;
+	using HalfEdge = HalfEdgeT<IndexT>;
+	using Face = FaceT<IndexT>;
+
+	MeshT() {}
 	/*HDS_Mesh(vector<Vertex> &vs, vector<HalfEdge> &hes, vector<Face> &fs)
 		: verts(std::move(vs))
 		, halfedges(std::move(hes))
 		, faces(std::move(fs)) {}*/
-	Mesh(const Mesh &other)
+	MeshT(const MeshT &other)
 		: /*verts(other.verts),*/ halfedges(other.halfedges), faces(other.faces)
+		, freeHalfEdges(other.freeHalfEdges), freeFaces(other.freeFaces)
 	{
 	}
-	~Mesh() {}
-
-	// Reset UID in each component
-	// Mask(Bitwise Operation): face|edge|vertex
-	//    e.g. All(111==3), Vertex Only(001==1), Vertex+Edge(011==3)
-	static void resetIndex(uint8_t reset_mask = 7)
-	{
-		//if (reset_mask & 1) HDS_Vertex::resetIndex();
-		if (reset_mask & 2) HalfEdge::resetIndex();
-		if (reset_mask & 4) Face::resetIndex();
-	}
+	~MeshT() {}
 
 	void printInfo(const std::string &msg = "")
 	{
@@ -139,6 +136,9 @@ public:
 		std::cout << "#half edges = " << halfedges.size() << std::endl;
 	}
 
+	IndexT heIndex(const HalfEdge* he) const { return static_cast<IndexT>(he - halfedges.data()); }
+	IndexT faceIndex(const Face* face) const { return static_cast<IndexT>(face - faces.data()); }
+
 	HalfEdge* heFromFace(SizeType fid) { return &halfedges[faces[fid].heid]; }
 	//HalfEdge* heFromVert(SizeType vid) { return &halfedges[verts[vid].heid]; }
 	//Vertex* vertFromHe(SizeType heid) { return &verts[halfedges[heid].vid]; }
@@ -148,49 +148,91 @@ public:
 	//const Vertex* vertFromHe(SizeType heid) const { return &verts[halfedges[heid].vid]; }
 	const Face* faceFromHe(SizeType heid) const { return &faces[halfedges[heid].fid]; }
 
-	// Returns pointer to new Half-Edges
-	void insertNewVertexOnEdge(HalfEdge*& outNewHE,
-							   Face*& outNewFace,
+	// Writes pointers to the new Half-Edges and Faces, 6 and 2
+	void insertNewVertexOnEdge(HalfEdge** outNewHE,
+							   Face** outNewFace,
 							   SizeType vId,
 							   SizeType heId);
 
-	void insertNewVertexInFace(HalfEdge*& outNewHE,
-							   Face*& outNewFace,
+	// Edge without flip, only the face on its left is split, 3 new Half-Edges and 1 Face
+	void insertNewVertexOnBoundaryEdge(HalfEdge** outNewHE,
+									   Face** outNewFace,
+									   SizeType vId,
+									   SizeType heId);
+
+	// 6 new Half-Edges and 2 Faces
+	void insertNewVertexInFace(HalfEdge** outNewHE,
+							   Face** outNewFace,
 							   SizeType vId,
 							   SizeType fId);
 
+	// Up to 6 Half-Edges and 2 Faces, removed slots are taken first, then the arrays grow,
+	// which moves every component, so pointers are only handed out once all are allocated
+	void allocate(SizeType heCount, HalfEdge** outHEs, SizeType faceCount, Face** outFaces);
+	// Unlinked components go back to the free lists, invalid until reused
+	void release(HalfEdge& he)
+	{
+		he = HalfEdge();
+		freeHalfEdges.push_back(heIndex(&he));
+	}
+	void release(Face& face)
+	{
+		face.setToInvalid();
+		freeFaces.push_back(faceIndex(&face));
+	}
+
+	void linkFace(HalfEdge& he1, HalfEdge& he2, HalfEdge& he3, Face& face)
+	{
+		// Link HE-F
+		he1.fid = he2.fid = he3.fid = faceIndex(&face);
+		face.heid = heIndex(&he1);
+	}
+
+	// Given an original edge, two new HE
+	void constructFace(HalfEdge& newHE0, HalfEdge& newHE1, HalfEdge& newHE2, Face& face);
+
 	//vector<Vertex> verts;
 	vector<HalfEdge> halfedges;
 	vector<Face>     faces;
+	// Slots of removed components
+	vector<IndexT>   freeHalfEdges;
+	vector<IndexT>   freeFaces;
 };
 
-inline void linkHalfEdge(HalfEdge& prev, HalfEdge& next)
+using Vertex = VertexT<SizeType>;
+using HalfEdge = HalfEdgeT<SizeType>;
+using Face = FaceT<SizeType>;
+using Mesh = MeshT<SizeType>;
+
+// 32-bit ids and offsets, 20 bytes per half-edge instead of 40
+// Holds up to 2^31 half-edges
+using CompactHalfEdge = HalfEdgeT<uint32_t>;
+using CompactFace = FaceT<uint32_t>;
+using CompactMesh = MeshT<uint32_t>;
+
+template <typename IndexT>
+inline void linkHalfEdge(HalfEdgeT<IndexT>& prev, HalfEdgeT<IndexT>& next)
 {
-	prev.next_offset = next.index - prev.index;
+	prev.next_offset = static_cast<typename HalfEdgeT<IndexT>::Offset>(&next - &prev);
 	next.prev_offset = -prev.next_offset;
 }
 
-inline void linkEdgeLoop(HalfEdge& he1, HalfEdge& he2, HalfEdge& he3)
+template <typename IndexT>
+inline void linkEdgeLoop(HalfEdgeT<IndexT>& he1, HalfEdgeT<IndexT>& he2, HalfEdgeT<IndexT>& he3)
 {
 	linkHalfEdge(he1, he2);
 	linkHalfEdge(he2, he3);
 	linkHalfEdge(he3, he1);
 }
 
-inline void linkVertex(HalfEdge& he1, SizeType ptId)
-{
-	he1.vid = ptId;
-}
-
-inline void linkFace(HalfEdge& he1, HalfEdge& he2, HalfEdge& he3, Face& face)
+template <typename IndexT>
+inline void linkVertex(HalfEdgeT<IndexT>& he1, SizeType ptId)
 {
-	// Link HE-F
-	he1.fid = he2.fid = he3.fid = face.index;
-	face.heid = he1.index;
+	he1.vid = static_cast<IndexT>(ptId);
 }
 
-// Given an original edge, two new HE
-inline void constructFace(
+template <typename IndexT>
+inline void MeshT<IndexT>::constructFace(
 	HalfEdge& newHE0, HalfEdge& newHE1, HalfEdge& newHE2, Face& face)
 {
 	// Link HE-HE
@@ -0,0 +1,125 @@
+#include "IncrementalConvexHull.h"
+
+IncrementalConvexHull::IncrementalConvexHull()
+	: mPointCount(0)
+{
+}
+
+IncrementalConvexHull::~IncrementalConvexHull()
+{
+}
+
+bool IncrementalConvexHull::insert(const Vector2f& point)
+{
+	const size_t id = mPointCount++;
+	// Both calls have to run, the point may extend either chain
+	const bool onLower = insertIntoChain(mLower, point, id, 1.0);
+	const bool onUpper = insertIntoChain(mUpper, point, id, -1.0);
+	return onLower || onUpper;
+}
+
+void IncrementalConvexHull::insert(const std::vector<Vector2f>& points)
+{
+	for (const Vector2f& p : points)
+	{
+		insert(p);
+	}
+}
+
+void IncrementalConvexHull::clear()
+{
+	mLower.clear();
+	mUpper.clear();
+	mPointCount = 0;
+}
+
+size_t IncrementalConvexHull::vertexCount() const
+{
+	// Both chains share the leftmost and the rightmost vertex
+	return mLower.size() < 2 ? mLower.size() : mLower.size() + mUpper.size() - 2;
+}
+
+bool IncrementalConvexHull::insertIntoChain(Chain& chain, const Vector2f& point, size_t id, double turn)
+{
+	// A duplicated point keeps the id it was first inserted with
+	auto next = chain.lower_bound(point);
+	if (next != chain.end() && !LexicographicLess()(point, next->first))
+	{
+		return false;
+	}
+
+	// Between two vertices the point has to be strictly outside their edge,
+	// beyond either end of the chain it is always a vertex
+	if (next != chain.end() && next != chain.begin())
+	{
+		auto prev = std::prev(next);
+		if (turn * Predicates::orient2d(prev->first, next->first, point) >= 0)
+		{
+			return false;
+		}
+	}
+
+	auto it = chain.emplace_hint(next, point, id);
+
+	// Drop the vertices which no longer turn the right way on either side
+	while (next != chain.end())
+	{
+		auto nextNext = std::next(next);
+		if (nextNext == chain.end()
+			|| turn * Predicates::orient2d(point, next->first, nextNext->first) > 0)
+		{
+			break;
+		}
+		chain.erase(next);
+		next = nextNext;
+	}
+	while (it != chain.begin())
+	{
+		auto prev = std::prev(it);
+		if (prev == chain.begin()
+			|| turn * Predicates::orient2d(std::prev(prev)->first, prev->first, point) > 0)
+		{
+			break;
+		}
+		chain.erase(prev);
+	}
+
+	return true;
+}
+
+template <typename Visitor>
+void IncrementalConvexHull::visitHull(Visitor visit) const
+{
+	if (vertexCount() < 2)
+	{
+		return;
+	}
+	// Lower chain left to right, then the upper one back without its ends
+	for (const auto& vertex : mLower)
+	{
+		visit(vertex);
+	}
+	auto upperEnd = std::prev(mUpper.rend());
+	for (auto it = std::next(mUpper.rbegin()); it != upperEnd; ++it)
+	{
+		visit(*it);
+	}
+}
+
+void IncrementalConvexHull::extractLineSegmentIndices(std::vector<uint32_t>& indices) const
+{
+	indices.clear();
+	visitHull([&](const Chain::value_type& vertex)
+	{
+		indices.push_back(static_cast<uint32_t>(vertex.second));
+	});
+}
+
+void IncrementalConvexHull::extractHullPoints(std::vector<Vector2f>& points) const
+{
+	points.clear();
+	visitHull([&](const Chain::value_type& vertex)
+	{
+		points.push_back(vertex.first);
+	});
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Vector2.h"
+#include "Predicates.h"
+
+#include <map>
+
+// Convex hull of a growing point set
+// The lower and upper chains are kept in ordered maps, an insertion costs
+// O(log h) plus the vertices it removes, and a vertex is removed only once
+// Only hull vertices are stored, ids count the inserted points from 0
+class IncrementalConvexHull
+{
+public:
+	IncrementalConvexHull();
+	~IncrementalConvexHull();
+
+	// Returns true if point is a vertex of the hull afterwards
+	bool insert(const Vector2f& point);
+	void insert(const std::vector<Vector2f>& points);
+	void clear();
+
+	size_t pointCount() const { return mPointCount; }
+	size_t vertexCount() const;
+
+	// Hull corners counter-clockwise from the lexicographically smallest point,
+	// the same list ConvexHull gives with Algorithm::MonotoneChain for all inserted points
+	void extractLineSegmentIndices(std::vector<uint32_t>& indices) const;
+	void extractHullPoints(std::vector<Vector2f>& points) const;
+
+private:
+	// x then y, -0 and +0 compare equal
+	struct LexicographicLess
+	{
+		bool operator()(const Vector2f& a, const Vector2f& b) const
+		{
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		}
+	};
+	// Vertex position to id of the point
+	using Chain = std::map<Vector2f, size_t, LexicographicLess>;
+
+	// turn is 1 for the lower chain, which turns left, -1 for the upper one
+	// Returns true if point became a vertex of the chain
+	static bool insertIntoChain(Chain& chain, const Vector2f& point, size_t id, double turn);
+
+	template <typename Visitor>
+	void visitHull(Visitor visit) const;
+
+private:
+	Chain mLower;
+	Chain mUpper;
+	size_t mPointCount;
+};
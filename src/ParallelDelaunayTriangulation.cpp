@@ -0,0 +1,385 @@
+#include "ParallelDelaunayTriangulation.h"
+#include "Predicates.h"
+#include "RadixSort.h"
+
+// Sub-problems smaller than this are not worth a new task
+static const size_t cMinParallelSize = 4096;
+// Marks a recycled quad-edge in its dual data
+static const size_t cDeadEdge = static_cast<size_t>(-2);
+
+ParallelDelaunayTriangulation::ParallelDelaunayTriangulation(std::vector<Vector2f>& inPoints,
+															 size_t threadCount)
+	: mPoints(std::move(inPoints))
+	, mParallelDepth(0)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	// Each level of spawning doubles the number of running tasks
+	while ((size_t(1) << mParallelDepth) < threadCount)
+	{
+		mParallelDepth++;
+	}
+
+	// Sort by x then y, of duplicated points the first one is kept
+	std::vector<Utils::KeyedId<uint64_t>> keys(mPoints.size());
+	for (size_t i = 0; i < mPoints.size(); i++)
+	{
+		keys[i].key = Utils::lexicographicKey(mPoints[i]);
+		keys[i].id = i;
+	}
+	Utils::radixSort(keys, threadCount);
+	mSortedIds.clear();
+	mSortedIds.reserve(keys.size());
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		if (i == 0 || keys[i].key != keys[i - 1].key)
+		{
+			mSortedIds.push_back(keys[i].id);
+		}
+	}
+
+	mSortedPoints.reserve(mSortedIds.size());
+	for (size_t id : mSortedIds)
+	{
+		mSortedPoints.push_back(mPoints[id]);
+	}
+
+	if (mSortedIds.size() > 2)
+	{
+		mPools.emplace_back();
+		triangulate(0, mSortedIds.size(), 0, mPools.back());
+
+		buildMesh();
+	}
+}
+
+ParallelDelaunayTriangulation::~ParallelDelaunayTriangulation()
+{
+}
+
+ParallelDelaunayTriangulation::Edge* ParallelDelaunayTriangulation::rot(const Edge* e)
+{
+	uintptr_t addr = reinterpret_cast<uintptr_t>(e);
+	uintptr_t base = addr & ~uintptr_t(sizeof(QuadEdge) - 1);
+	return reinterpret_cast<Edge*>(base + ((addr + sizeof(Edge)) & (sizeof(QuadEdge) - 1)));
+}
+
+ParallelDelaunayTriangulation::Edge* ParallelDelaunayTriangulation::sym(const Edge* e)
+{
+	uintptr_t addr = reinterpret_cast<uintptr_t>(e);
+	uintptr_t base = addr & ~uintptr_t(sizeof(QuadEdge) - 1);
+	return reinterpret_cast<Edge*>(base + ((addr + 2 * sizeof(Edge)) & (sizeof(QuadEdge) - 1)));
+}
+
+ParallelDelaunayTriangulation::Edge* ParallelDelaunayTriangulation::invRot(const Edge* e)
+{
+	uintptr_t addr = reinterpret_cast<uintptr_t>(e);
+	uintptr_t base = addr & ~uintptr_t(sizeof(QuadEdge) - 1);
+	return reinterpret_cast<Edge*>(base + ((addr + 3 * sizeof(Edge)) & (sizeof(QuadEdge) - 1)));
+}
+
+ParallelDelaunayTriangulation::Edge* ParallelDelaunayTriangulation::makeEdge(
+	EdgePool& pool, size_t org, size_t dest)
+{
+	QuadEdge* q = nullptr;
+	if (pool.freeQuads.empty())
+	{
+		pool.quads.emplace_back();
+		q = &pool.quads.back();
+	}
+	else
+	{
+		q = pool.freeQuads.back();
+		pool.freeQuads.pop_back();
+	}
+
+	q->e[0].onext = &q->e[0];
+	q->e[1].onext = &q->e[3];
+	q->e[2].onext = &q->e[2];
+	q->e[3].onext = &q->e[1];
+	q->e[0].data = org;
+	q->e[1].data = cInvalidIndex;
+	q->e[2].data = dest;
+	q->e[3].data = cInvalidIndex;
+	return &q->e[0];
+}
+
+void ParallelDelaunayTriangulation::splice(Edge* a, Edge* b)
+{
+	Edge* alpha = rot(a->onext);
+	Edge* beta = rot(b->onext);
+
+	std::swap(a->onext, b->onext);
+	std::swap(alpha->onext, beta->onext);
+}
+
+ParallelDelaunayTriangulation::Edge* ParallelDelaunayTriangulation::connect(
+	EdgePool& pool, Edge* a, Edge* b)
+{
+	Edge* e = makeEdge(pool, dest(a), org(b));
+	splice(e, lnext(a));
+	splice(sym(e), b);
+	return e;
+}
+
+void ParallelDelaunayTriangulation::deleteEdge(EdgePool& pool, Edge* e)
+{
+	splice(e, oprev(e));
+	splice(sym(e), oprev(sym(e)));
+
+	// Primal edge e[0] or e[2] lies at an even slot
+	QuadEdge* q = reinterpret_cast<QuadEdge*>(
+		reinterpret_cast<uintptr_t>(e) & ~uintptr_t(sizeof(QuadEdge) - 1));
+	q->e[1].data = cDeadEdge;
+	pool.freeQuads.push_back(q);
+}
+
+bool ParallelDelaunayTriangulation::ccw(size_t a, size_t b, size_t c) const
+{
+	return Predicates::orient2d(mSortedPoints[a], mSortedPoints[b], mSortedPoints[c]) > 0;
+}
+
+bool ParallelDelaunayTriangulation::inCircle(size_t a, size_t b, size_t c, size_t d) const
+{
+	return Predicates::inCircle(mSortedPoints[a], mSortedPoints[b],
+								mSortedPoints[c], mSortedPoints[d]) > 0;
+}
+
+std::pair<ParallelDelaunayTriangulation::Edge*, ParallelDelaunayTriangulation::Edge*>
+ParallelDelaunayTriangulation::triangulate(size_t first, size_t last, size_t depth, EdgePool& pool)
+{
+	size_t count = last - first;
+	if (count == 2)
+	{
+		Edge* a = makeEdge(pool, first, first + 1);
+		return { a, sym(a) };
+	}
+	if (count == 3)
+	{
+		size_t s0 = first;
+		size_t s1 = first + 1;
+		size_t s2 = first + 2;
+		Edge* a = makeEdge(pool, s0, s1);
+		Edge* b = makeEdge(pool, s1, s2);
+		splice(sym(a), b);
+
+		if (ccw(s0, s1, s2))
+		{
+			connect(pool, b, a);
+			return { a, sym(b) };
+		}
+		if (ccw(s0, s2, s1))
+		{
+			Edge* c = connect(pool, b, a);
+			return { sym(c), c };
+		}
+		// Collinear
+		return { a, sym(b) };
+	}
+
+	// Split at x-median
+	size_t mid = first + count / 2;
+	std::pair<Edge*, Edge*> left, right;
+	if (depth < mParallelDepth && count >= cMinParallelSize)
+	{
+		EdgePool* leftPool = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mPoolMutex);
+			mPools.emplace_back();
+			leftPool = &mPools.back();
+		}
+		auto leftTask = std::async(std::launch::async, [=]()
+		{
+			return triangulate(first, mid, depth + 1, *leftPool);
+		});
+		right = triangulate(mid, last, depth + 1, pool);
+		left = leftTask.get();
+	}
+	else
+	{
+		left = triangulate(first, mid, depth + 1, pool);
+		right = triangulate(mid, last, depth + 1, pool);
+	}
+
+	return merge(pool, left, right);
+}
+
+std::pair<ParallelDelaunayTriangulation::Edge*, ParallelDelaunayTriangulation::Edge*>
+ParallelDelaunayTriangulation::merge(EdgePool& pool,
+									 std::pair<Edge*, Edge*> left,
+									 std::pair<Edge*, Edge*> right)
+{
+	Edge* ldo = left.first;
+	Edge* ldi = left.second;
+	Edge* rdi = right.first;
+	Edge* rdo = right.second;
+
+	// Find the lower common tangent of both halves
+	while (true)
+	{
+		if (leftOf(org(rdi), ldi))
+		{
+			ldi = lnext(ldi);
+		}
+		else if (rightOf(org(ldi), rdi))
+		{
+			rdi = rprev(rdi);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// Stitch the seam bottom-up, starting from the tangent
+	Edge* basel = connect(pool, sym(rdi), ldi);
+	if (org(ldi) == org(ldo))
+	{
+		ldo = sym(basel);
+	}
+	if (org(rdi) == org(rdo))
+	{
+		rdo = basel;
+	}
+
+	while (true)
+	{
+		// Remove left edges failing the circle test
+		Edge* lcand = sym(basel)->onext;
+		bool lValid = rightOf(dest(lcand), basel);
+		if (lValid)
+		{
+			while (inCircle(dest(basel), org(basel), dest(lcand), dest(lcand->onext)))
+			{
+				Edge* t = lcand->onext;
+				deleteEdge(pool, lcand);
+				lcand = t;
+			}
+		}
+
+		// Symmetrically on the right side
+		Edge* rcand = oprev(basel);
+		bool rValid = rightOf(dest(rcand), basel);
+		if (rValid)
+		{
+			while (inCircle(dest(basel), org(basel), dest(rcand), dest(oprev(rcand))))
+			{
+				Edge* t = oprev(rcand);
+				deleteEdge(pool, rcand);
+				rcand = t;
+			}
+		}
+
+		lValid = rightOf(dest(lcand), basel);
+		rValid = rightOf(dest(rcand), basel);
+		// Reached the upper common tangent
+		if (!lValid && !rValid)
+		{
+			break;
+		}
+
+		if (!lValid ||
+			(rValid && inCircle(dest(lcand), org(lcand), org(rcand), dest(rcand))))
+		{
+			basel = connect(pool, rcand, sym(basel));
+		}
+		else
+		{
+			basel = connect(pool, sym(basel), sym(lcand));
+		}
+	}
+
+	return { ldo, rdo };
+}
+
+void ParallelDelaunayTriangulation::buildMesh()
+{
+	std::vector<HDS::HalfEdge>& hes = mMesh.halfedges;
+
+	size_t edgeCount = 0;
+	for (auto& pool : mPools)
+	{
+		edgeCount += pool.quads.size() - pool.freeQuads.size();
+	}
+	// Euler formula, outer face excluded, only reserves
+	// as the mesh grows with the triangles actually found
+	const size_t faceCount = edgeCount + 1 > mSortedIds.size() ? edgeCount + 1 - mSortedIds.size() : 0;
+	hes.reserve(3 * faceCount);
+	mMesh.faces.reserve(faceCount);
+	std::vector<Edge*> heToEdge;
+	heToEdge.reserve(3 * faceCount);
+
+	// Every counter-clockwise 3-cycle of lnext is a triangle
+	for (auto& pool : mPools)
+	{
+		for (QuadEdge& q : pool.quads)
+		{
+			if (q.e[1].data == cDeadEdge)
+			{
+				continue;
+			}
+			for (Edge* e : { &q.e[0], &q.e[2] })
+			{
+				if (rot(e)->data != cInvalidIndex)
+				{
+					continue;
+				}
+				Edge* e1 = lnext(e);
+				Edge* e2 = lnext(e1);
+				if (lnext(e2) != e || !ccw(org(e), org(e1), org(e2)))
+				{
+					continue;
+				}
+
+				const size_t heId = hes.size();
+				hes.resize(heId + 3);
+				mMesh.faces.emplace_back();
+				std::array<Edge*, 3> triEdges{ e, e1, e2 };
+				for (size_t i = 0; i < 3; i++)
+				{
+					rot(triEdges[i])->data = heId + i;
+					hes[heId + i].vid = mSortedIds[org(triEdges[i])];
+					heToEdge.push_back(triEdges[i]);
+				}
+				mMesh.constructFace(hes[heId], hes[heId + 1], hes[heId + 2], mMesh.faces.back());
+			}
+		}
+	}
+
+	// Hull edges keep flip_offset == 0
+	for (size_t i = 0; i < hes.size(); i++)
+	{
+		size_t flipId = rot(sym(heToEdge[i]))->data;
+		if (flipId != cInvalidIndex && flipId > i)
+		{
+			hes[i].setFlip(&hes[flipId]);
+		}
+	}
+}
+
+void ParallelDelaunayTriangulation::extractTriangleIndices(std::vector<uint32_t>& outIndices) const
+{
+	for (size_t fid = 0; fid < mMesh.faces.size(); fid++)
+	{
+		if (mMesh.faces[fid].isInvalid())
+		{
+			continue;
+		}
+
+		const HDS::HalfEdge* he = mMesh.heFromFace(fid);
+		const HDS::HalfEdge* curHE = he;
+
+		std::array<uint32_t, 3> vids;
+		size_t localVidIdx = 0;
+
+		do
+		{
+			vids[localVidIdx++] = static_cast<uint32_t>(curHE->vid);
+			curHE = curHE->next();
+		} while (curHE != he);
+
+		outIndices.insert(outIndices.end(), vids.begin(), vids.end());
+	}
+}
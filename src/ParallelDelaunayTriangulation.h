@@ -0,0 +1,86 @@
+#pragma once
+#include "common.h"
+#include "Vector2.h"
+#include "HalfEdge.h"
+#include "PointSet.h"
+
+// Divide-and-conquer Delaunay triangulation (Guibas-Stolfi)
+// Halves split at the x-median are triangulated concurrently
+// and stitched together along the seam between them
+class ParallelDelaunayTriangulation
+{
+public:
+	// threadCount == 0 uses all hardware threads
+	ParallelDelaunayTriangulation(std::vector<Vector2f>& inPoints, size_t threadCount = 0);
+	~ParallelDelaunayTriangulation();
+
+	void extractTriangleIndices(std::vector<uint32_t>& outIndices) const;
+	const HDS::Mesh& mesh() const { return mMesh; }
+
+private:
+	// Quad-edge record of 4 rotated edges packed in one cache line,
+	// rotation index is recovered from the address
+	//     e[0], e[2]: primal edges, data is sorted position of origin vertex
+	//     e[1], e[3]: dual edges, data is the half-edge built from e[0]/e[2]
+	struct Edge
+	{
+		Edge* onext;
+		size_t data;
+	};
+	struct alignas(64) QuadEdge
+	{
+		Edge e[4];
+	};
+
+	// Per-task edge storage, deque keeps addresses stable while growing
+	// Deleted quad-edges are recycled through the free list
+	// The allocator is explicit since operator new ignores alignas before C++17
+	struct EdgePool
+	{
+		std::deque<QuadEdge, AlignedAllocator<QuadEdge, alignof(QuadEdge)>> quads;
+		std::vector<QuadEdge*> freeQuads;
+	};
+
+	static Edge* rot(const Edge* e);
+	static Edge* sym(const Edge* e);
+	static Edge* invRot(const Edge* e);
+	static Edge* oprev(const Edge* e) { return rot(rot(e)->onext); }
+	static Edge* lnext(const Edge* e) { return rot(invRot(e)->onext); }
+	static Edge* rprev(const Edge* e) { return sym(e)->onext; }
+	static size_t org(const Edge* e) { return e->data; }
+	static size_t dest(const Edge* e) { return sym(e)->data; }
+
+	static Edge* makeEdge(EdgePool& pool, size_t org, size_t dest);
+	static void splice(Edge* a, Edge* b);
+	static Edge* connect(EdgePool& pool, Edge* a, Edge* b);
+	static void deleteEdge(EdgePool& pool, Edge* e);
+
+	bool ccw(size_t a, size_t b, size_t c) const;
+	bool rightOf(size_t p, const Edge* e) const { return ccw(p, dest(e), org(e)); }
+	bool leftOf(size_t p, const Edge* e) const { return ccw(p, org(e), dest(e)); }
+	bool inCircle(size_t a, size_t b, size_t c, size_t d) const;
+
+	// Triangulate sorted positions [first, last), returns (ccw hull edge out of
+	// leftmost point, cw hull edge out of rightmost point)
+	std::pair<Edge*, Edge*> triangulate(size_t first, size_t last, size_t depth, EdgePool& pool);
+	std::pair<Edge*, Edge*> merge(EdgePool& pool,
+								  std::pair<Edge*, Edge*> left,
+								  std::pair<Edge*, Edge*> right);
+
+	void buildMesh();
+
+private:
+	std::vector<Vector2f> mPoints;
+	// Unique point ids sorted by x then y
+	std::vector<size_t> mSortedIds;
+	// Points in sorted order, quad-edges refer to vertices by sorted position
+	std::vector<Vector2f> mSortedPoints;
+
+	// Pools of all recursion tasks, guarded by mPoolMutex while registering
+	std::deque<EdgePool> mPools;
+	std::mutex mPoolMutex;
+	// Recursion depth below which tasks are no longer spawned
+	size_t mParallelDepth;
+
+	HDS::Mesh mMesh;
+};
@@ -0,0 +1,124 @@
+#include "PointSet.h"
+
+PointSet::PointSet()
+	: mX(nullptr)
+	, mY(nullptr)
+	, mStride(2)
+	, mSize(0)
+	, mBorrowed(false)
+{
+}
+
+PointSet::PointSet(std::vector<Vector2f>& points)
+	: mAoS(std::move(points))
+	, mStride(2)
+	, mBorrowed(false)
+{
+	bindView();
+}
+
+PointSet::PointSet(Vector2SoA& points)
+	: mSoA(std::move(points))
+	, mStride(1)
+	, mBorrowed(false)
+{
+	bindView();
+}
+
+PointSet::PointSet(const Vector2f* points, size_t count)
+	: mX(count > 0 ? &points->x : nullptr)
+	, mY(count > 0 ? &points->y : nullptr)
+	, mStride(2)
+	, mSize(count)
+	, mBorrowed(true)
+{
+}
+
+PointSet::PointSet(PointSet&& other)
+	: mAoS(std::move(other.mAoS))
+	, mSoA(std::move(other.mSoA))
+	, mX(other.mX)
+	, mY(other.mY)
+	, mStride(other.mStride)
+	, mSize(other.mSize)
+	, mBorrowed(other.mBorrowed)
+{
+	bindView();
+	other.bindView();
+}
+
+PointSet& PointSet::operator=(PointSet&& other)
+{
+	mAoS = std::move(other.mAoS);
+	mSoA = std::move(other.mSoA);
+	mX = other.mX;
+	mY = other.mY;
+	mStride = other.mStride;
+	mSize = other.mSize;
+	mBorrowed = other.mBorrowed;
+	bindView();
+	other.bindView();
+	return *this;
+}
+
+void PointSet::push_back(const Vector2f& p)
+{
+	ownStorage();
+	if (mStride == 1)
+	{
+		mSoA.push_back(p);
+	}
+	else
+	{
+		mAoS.push_back(p);
+	}
+	bindView();
+}
+
+void PointSet::set(size_t i, const Vector2f& p)
+{
+	ownStorage();
+	if (mStride == 1)
+	{
+		mSoA.x[i] = p.x;
+		mSoA.y[i] = p.y;
+	}
+	else
+	{
+		mAoS[i] = p;
+	}
+}
+
+void PointSet::ownStorage()
+{
+	if (mBorrowed)
+	{
+		const Vector2f* points = aosData();
+		mAoS.assign(points, points + mSize);
+		mBorrowed = false;
+		bindView();
+	}
+}
+
+void PointSet::bindView()
+{
+	if (mBorrowed)
+	{
+		return;
+	}
+	if (mStride == 1)
+	{
+		assert(mSoA.x.size() == mSoA.y.size());
+		mX = mSoA.x.data();
+		mY = mSoA.y.data();
+		mSize = mSoA.size();
+	}
+	else
+	{
+		// Vector2f is two tightly packed floats
+		static_assert(sizeof(Vector2f) == 2 * sizeof(float), "Vector2f must not be padded");
+		mX = mAoS.empty() ? nullptr : &mAoS.front().x;
+		mY = mAoS.empty() ? nullptr : &mAoS.front().y;
+		mSize = mAoS.size();
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "Vector2.h"
+
+// Allocator returning storage aligned to Alignment bytes, so SIMD loads
+// over coordinate arrays never straddle a vector boundary
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = AlignedAllocator<U, Alignment>;
+	};
+
+	AlignedAllocator() = default;
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	T* allocate(size_t n)
+	{
+		// Over-allocate and keep the original pointer right before the aligned block
+		void* raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void*));
+		uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + Alignment - 1)
+			& ~static_cast<uintptr_t>(Alignment - 1);
+		reinterpret_cast<void**>(aligned)[-1] = raw;
+		return reinterpret_cast<T*>(aligned);
+	}
+	void deallocate(T* p, size_t)
+	{
+		::operator delete(reinterpret_cast<void**>(p)[-1]);
+	}
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+// Structure of arrays point storage, point i is (x[i], y[i])
+struct Vector2SoA
+{
+	using FloatArray = std::vector<float, AlignedAllocator<float, 32>>;
+
+	FloatArray x;
+	FloatArray y;
+
+	size_t size() const { return x.size(); }
+	bool empty() const { return x.empty(); }
+	void reserve(size_t count)
+	{
+		x.reserve(count);
+		y.reserve(count);
+	}
+	void push_back(const Vector2f& p)
+	{
+		x.push_back(p.x);
+		y.push_back(p.y);
+	}
+	Vector2f operator[](size_t i) const { return Vector2f(x[i], y[i]); }
+};
+
+// Point input of the geometry algorithms
+// Owns either interleaved Vector2f (AoS) or separate x/y arrays (SoA),
+// and reads both through the same strided view
+class PointSet
+{
+public:
+	PointSet();
+	// Both take over the storage of points, leaving it empty
+	explicit PointSet(std::vector<Vector2f>& points);
+	explicit PointSet(Vector2SoA& points);
+	// Reads count interleaved points in place, they have to outlive the set
+	PointSet(const Vector2f* points, size_t count);
+
+	// Views point into the owned buffers, which survive a move but not a copy
+	PointSet(PointSet&& other);
+	PointSet& operator=(PointSet&& other);
+	PointSet(const PointSet&) = delete;
+	PointSet& operator=(const PointSet&) = delete;
+
+	size_t size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+	Vector2f operator[](size_t i) const
+	{
+		return Vector2f(mX[i * mStride], mY[i * mStride]);
+	}
+	float x(size_t i) const { return mX[i * mStride]; }
+	float y(size_t i) const { return mY[i * mStride]; }
+
+	// Appends to the owned storage, borrowed points are copied over first
+	void push_back(const Vector2f& p);
+	// Moves point i, likewise copying borrowed points first
+	void set(size_t i, const Vector2f& p);
+
+	bool isSoA() const { return mStride == 1; }
+	// Interleaved points for vertex buffer upload, nullptr when stored as SoA
+	const Vector2f* aosData() const { return isSoA() ? nullptr : reinterpret_cast<const Vector2f*>(mX); }
+
+private:
+	void bindView();
+	void ownStorage();
+
+private:
+	std::vector<Vector2f> mAoS;
+	Vector2SoA mSoA;
+
+	// x of point i is mX[i * mStride], y likewise
+	const float* mX;
+	const float* mY;
+	size_t mStride;
+	size_t mSize;
+	// The view points into storage owned by the caller
+	bool mBorrowed;
+};
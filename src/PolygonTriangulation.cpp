@@ -1,14 +1,799 @@
 #include "PolygonTriangulation.h"
+#include "RadixSort.h"
+#include "SpatialSort.h"
 
-PolygonTriangulation::PolygonTriangulation(std::vector<Vector2f> &points)
-	: mPoints(std::move(points))
+namespace
+{
+
+const size_t cNoVertex = static_cast<size_t>(-1);
+// Polygons a batch thread takes at once
+const size_t cBatchBlockSize = 64;
+
+}
+
+PolygonTriangulation::PolygonTriangulation(PointSet &&points, const std::vector<size_t> &ringOffsets, Algorithm algorithm)
+	: PolygonTriangulation()
+{
+	triangulate(std::move(points), ringOffsets, algorithm);
+}
+
+PolygonTriangulation::PolygonTriangulation(std::vector<Vector2f> &points, const std::vector<size_t> &ringOffsets, Algorithm algorithm)
+	: PolygonTriangulation(PointSet(points), ringOffsets, algorithm)
+{
+}
+
+PolygonTriangulation::PolygonTriangulation(Vector2SoA &points, const std::vector<size_t> &ringOffsets, Algorithm algorithm)
+	: PolygonTriangulation(PointSet(points), ringOffsets, algorithm)
+{
+}
+
+PolygonTriangulation::PolygonTriangulation(PointSet &&points, Algorithm algorithm)
+	: PolygonTriangulation(std::move(points), std::vector<size_t>{ 0 }, algorithm)
+{
+}
+
+PolygonTriangulation::PolygonTriangulation(std::vector<Vector2f> &points, Algorithm algorithm)
+	: PolygonTriangulation(PointSet(points), std::vector<size_t>{ 0 }, algorithm)
+{
+}
+
+PolygonTriangulation::PolygonTriangulation(Vector2SoA &points, Algorithm algorithm)
+	: PolygonTriangulation(PointSet(points), std::vector<size_t>{ 0 }, algorithm)
+{
+}
+
+PolygonTriangulation::PolygonTriangulation()
+	: mVertexCount(0)
+	, mHoleCount(0)
 {
 }
 
 PolygonTriangulation::~PolygonTriangulation()
 {
 }
+
+void PolygonTriangulation::triangulateBatch(const std::vector<Vector2f> &points,
+											const std::vector<size_t> &ringOffsets,
+											const std::vector<size_t> &polygonOffsets,
+											std::vector<uint32_t> &indices,
+											std::vector<size_t> &indexOffsets,
+											Algorithm algorithm,
+											size_t threadCount)
+{
+	const size_t polygonCount = polygonOffsets.size();
+	auto ringEnd = [&](size_t ring)
+	{
+		return ring + 1 < ringOffsets.size() ? ringOffsets[ring + 1] : points.size();
+	};
+	auto polygonEnd = [&](size_t polygon)
+	{
+		return polygon + 1 < polygonCount ? polygonOffsets[polygon + 1] : ringOffsets.size();
+	};
+
+	// Sizes are known up front, rings with fewer than three points are skipped like in triangulate
+	indexOffsets.resize(polygonCount + 1);
+	indexOffsets[0] = 0;
+	for (size_t polygon = 0; polygon < polygonCount; polygon++)
+	{
+		const size_t outer = polygonOffsets[polygon];
+		size_t triangleCount = 0;
+		if (outer < polygonEnd(polygon) && ringEnd(outer) >= ringOffsets[outer] + 3)
+		{
+			triangleCount = ringEnd(outer) - ringOffsets[outer] - 2;
+			for (size_t ring = outer + 1; ring < polygonEnd(polygon); ring++)
+			{
+				const size_t size = ringEnd(ring) - ringOffsets[ring];
+				if (size >= 3)
+				{
+					triangleCount += size + 2;
+				}
+			}
+		}
+		indexOffsets[polygon + 1] = indexOffsets[polygon] + 3 * triangleCount;
+	}
+	indices.resize(indexOffsets[polygonCount]);
+
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	const size_t blockCount = (polygonCount + cBatchBlockSize - 1) / cBatchBlockSize;
+	threadCount = std::max<size_t>(1, std::min(threadCount, blockCount));
+
+	// Polygons vary in size, so threads take blocks of them as they go
+	std::atomic<size_t> nextBlock(0);
+	auto work = [&]()
+	{
+		PolygonTriangulation scratch;
+		std::vector<size_t> localOffsets;
+		for (size_t block = nextBlock++; block < blockCount; block = nextBlock++)
+		{
+			const size_t last = std::min((block + 1) * cBatchBlockSize, polygonCount);
+			for (size_t polygon = block * cBatchBlockSize; polygon < last; polygon++)
+			{
+				const size_t outer = polygonOffsets[polygon];
+				const size_t end = polygonEnd(polygon);
+				if (outer >= end)
+				{
+					continue;
+				}
+				const size_t base = ringOffsets[outer];
+				localOffsets.clear();
+				for (size_t ring = outer; ring < end; ring++)
+				{
+					localOffsets.push_back(ringOffsets[ring] - base);
+				}
+				scratch.triangulate(PointSet(points.data() + base, ringEnd(end - 1) - base), localOffsets, algorithm);
+
+				// Only input that is not simple yields another count than reserved
+				uint32_t* out = indices.data() + indexOffsets[polygon];
+				const size_t capacity = indexOffsets[polygon + 1] - indexOffsets[polygon];
+				const size_t count = std::min(capacity, scratch.mTriangles.size());
+				for (size_t i = 0; i < count; i++)
+				{
+					out[i] = scratch.mTriangles[i] + static_cast<uint32_t>(base);
+				}
+				std::fill(out + count, out + capacity, static_cast<uint32_t>(base));
+			}
+		}
+	};
+
+	std::vector<std::future<void>> tasks;
+	for (size_t thread = 1; thread < threadCount; thread++)
+	{
+		tasks.push_back(std::async(std::launch::async, work));
+	}
+	work();
+	for (auto& task : tasks)
+	{
+		task.get();
+	}
+}
+
+void PolygonTriangulation::triangulate(PointSet &&points, const std::vector<size_t> &ringOffsets, Algorithm algorithm)
+{
+	mPoints = std::move(points);
+	mVertexCount = 0;
+	mHoleCount = 0;
+	mEdges.clear();
+	mNextVertex.clear();
+	mPrevVertex.clear();
+	mMonotones.clear();
+	mDiagonals.clear();
+	mTriangles.clear();
+	if (mPoints.size() < 3)
+	{
+		return;
+	}
+
+	initEdges(ringOffsets);
+	if (mVertexCount < 3)
+	{
+		return;
+	}
+	if (mHoleCount == 0
+		&& (algorithm == Algorithm::EarClipping
+			|| (algorithm == Algorithm::Auto && mVertexCount < cEarClippingMaxSize)))
+	{
+		clipEars();
+		return;
+	}
+	sortEvents();
+	partition();
+	splitMonotones();
+	triangulateMonotones();
+}
+
+void PolygonTriangulation::extractTriangleIndices(std::vector<uint32_t> &indices) const
+{
+	indices = mTriangles;
+}
+
 void PolygonTriangulation::getLineIndexBuffer(std::vector<uint32_t> &indices) const
 {
+	indices.clear();
+	if (mTriangles.empty())
+	{
+		return;
+	}
 
-}
\ No newline at end of file
+	// Inner edges show up in two triangles, once in each direction,
+	// sides only once and in polygon order
+	std::vector<size_t> nextPid(mPoints.size());
+	for (size_t v = 0; v < mVertexCount; v++)
+	{
+		nextPid[mEdges[v].pid] = mEdges[nextVertex(v)].pid;
+	}
+	for (size_t i = 0; i < mTriangles.size(); i += 3)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			const uint32_t a = mTriangles[i + j];
+			const uint32_t b = mTriangles[i + (j + 1) % 3];
+			if (a < b || nextPid[a] == b)
+			{
+				indices.push_back(a);
+				indices.push_back(b);
+			}
+		}
+	}
+}
+
+void PolygonTriangulation::initEdges(const std::vector<size_t> &ringOffsets)
+{
+	const size_t pointCount = mPoints.size();
+	mEdges.reserve(pointCount);
+	mNextVertex.reserve(pointCount);
+	mPrevVertex.reserve(pointCount);
+
+	size_t n = 0;
+	for (size_t ring = 0; ring < ringOffsets.size(); ring++)
+	{
+		const size_t first = ringOffsets[ring];
+		const size_t last = ring + 1 < ringOffsets.size() ? ringOffsets[ring + 1] : pointCount;
+		// A degenerate hole encloses nothing, without the outer ring there is no polygon
+		if (last < first + 3)
+		{
+			if (ring == 0)
+			{
+				break;
+			}
+			continue;
+		}
+
+		// Twice the signed area decides the orientation, the interior is kept on the left,
+		// counter-clockwise for the outer ring and clockwise for holes
+		double area = 0;
+		for (size_t i = first, j = last - 1; i < last; j = i++)
+		{
+			const Vector2f p = mPoints[j];
+			const Vector2f q = mPoints[i];
+			area += double(p.x) * q.y - double(q.x) * p.y;
+		}
+		const bool reversed = ring == 0 ? area < 0 : area > 0;
+
+		const size_t size = last - first;
+		for (size_t k = 0; k < size; k++)
+		{
+			const size_t v = n + k;
+			Edge edge;
+			edge.prev_offset = k > 0 ? -1 : static_cast<ptrdiff_t>(size - 1);
+			edge.next_offset = k + 1 < size ? 1 : -static_cast<ptrdiff_t>(size - 1);
+			edge.pid = reversed ? last - 1 - k : first + k;
+			edge.id = v;
+			mEdges.push_back(edge);
+			mNextVertex.push_back(k + 1 < size ? v + 1 : n);
+			mPrevVertex.push_back(k > 0 ? v - 1 : n + size - 1);
+		}
+		n += size;
+		if (ring > 0)
+		{
+			mHoleCount++;
+		}
+	}
+	mVertexCount = n;
+}
+
+void PolygonTriangulation::sortEvents()
+{
+	// Negated y in the high half, top to bottom then left to right
+	std::vector<Utils::KeyedId<uint64_t>> keys(mVertexCount);
+	for (size_t v = 0; v < mVertexCount; v++)
+	{
+		const Vector2f p = vertex(v);
+		keys[v].key = (static_cast<uint64_t>(Utils::sortableBits(-p.y)) << 32) | Utils::sortableBits(p.x);
+		keys[v].id = v;
+	}
+	Utils::radixSort(keys);
+
+	mEvents.resize(mVertexCount);
+	mEventRank.resize(mVertexCount);
+	for (size_t i = 0; i < mVertexCount; i++)
+	{
+		mEvents[i] = keys[i].id;
+		mEventRank[keys[i].id] = i;
+	}
+}
+
+PolygonTriangulation::VertexType PolygonTriangulation::classify(size_t v) const
+{
+	const size_t prev = prevVertex(v);
+	const size_t next = nextVertex(v);
+	const bool prevBelow = above(v, prev);
+	const bool nextBelow = above(v, next);
+	const bool convex = Predicates::orient2d(vertex(prev), vertex(v), vertex(next)) > 0;
+
+	if (prevBelow && nextBelow)
+	{
+		return convex ? VertexType::Start : VertexType::Split;
+	}
+	if (!prevBelow && !nextBelow)
+	{
+		return convex ? VertexType::End : VertexType::Merge;
+	}
+	// Going down on the left chain, the interior is to the right
+	return prevBelow ? VertexType::RegularRight : VertexType::RegularLeft;
+}
+
+// Sides in the status go down from their start vertex and have the interior on the right
+bool PolygonTriangulation::SweepLess::operator()(size_t a, size_t b) const
+{
+	if (a == b)
+	{
+		return false;
+	}
+	const Vector2f upperA = self->vertex(a);
+	const Vector2f lowerA = self->vertex(self->nextVertex(a));
+	const Vector2f upperB = self->vertex(b);
+	const Vector2f lowerB = self->vertex(self->nextVertex(b));
+	// Test the side that started later against the line of the other one,
+	// with the lower end if the upper one is shared
+	if (self->above(b, a))
+	{
+		double side = Predicates::orient2d(upperB, lowerB, upperA);
+		if (side == 0)
+		{
+			side = Predicates::orient2d(upperB, lowerB, lowerA);
+		}
+		return side < 0;
+	}
+	double side = Predicates::orient2d(upperA, lowerA, upperB);
+	if (side == 0)
+	{
+		side = Predicates::orient2d(upperA, lowerA, lowerB);
+	}
+	return side > 0;
+}
+
+bool PolygonTriangulation::SweepLess::operator()(size_t side, const Vector2f& p) const
+{
+	return Predicates::orient2d(self->vertex(side), self->vertex(self->nextVertex(side)), p) > 0;
+}
+
+bool PolygonTriangulation::SweepLess::operator()(const Vector2f& p, size_t side) const
+{
+	return Predicates::orient2d(self->vertex(side), self->vertex(self->nextVertex(side)), p) < 0;
+}
+
+void PolygonTriangulation::partition()
+{
+	const size_t n = mVertexCount;
+	std::vector<VertexType> types(n);
+	for (size_t v = 0; v < n; v++)
+	{
+		types[v] = classify(v);
+	}
+
+	// Side i goes from vertex i to the next one, its helper is the lowest vertex
+	// above the sweep line that sees it horizontally to the right
+	SweepStatus status(SweepLess{ this });
+	std::vector<SweepStatus::iterator> sides(n, status.end());
+	std::vector<size_t> helpers(n, cNoVertex);
+
+	auto insertSide = [&](size_t side)
+	{
+		sides[side] = status.insert(side);
+		helpers[side] = side;
+	};
+	auto eraseSide = [&](size_t side)
+	{
+		if (sides[side] != status.end())
+		{
+			status.erase(sides[side]);
+			sides[side] = status.end();
+		}
+	};
+	// A merge vertex still waits for a vertex below it to connect to
+	auto connectMergeHelper = [&](size_t side, size_t v)
+	{
+		const size_t helper = helpers[side];
+		if (helper != cNoVertex && types[helper] == VertexType::Merge)
+		{
+			addDiagonal(v, helper);
+		}
+	};
+	// Side directly left of v, cNoVertex only for degenerate input
+	auto leftSide = [&](size_t v)
+	{
+		auto it = status.lower_bound(vertex(v));
+		return it == status.begin() ? cNoVertex : *std::prev(it);
+	};
+
+	for (size_t v : mEvents)
+	{
+		const size_t prev = prevVertex(v);
+		switch (types[v])
+		{
+		case VertexType::Start:
+			insertSide(v);
+			break;
+		case VertexType::End:
+			connectMergeHelper(prev, v);
+			eraseSide(prev);
+			break;
+		case VertexType::Split:
+		{
+			const size_t left = leftSide(v);
+			if (left != cNoVertex)
+			{
+				addDiagonal(v, helpers[left]);
+				helpers[left] = v;
+			}
+			insertSide(v);
+			break;
+		}
+		case VertexType::Merge:
+		{
+			connectMergeHelper(prev, v);
+			eraseSide(prev);
+			const size_t left = leftSide(v);
+			if (left != cNoVertex)
+			{
+				connectMergeHelper(left, v);
+				helpers[left] = v;
+			}
+			break;
+		}
+		case VertexType::RegularLeft:
+			connectMergeHelper(prev, v);
+			eraseSide(prev);
+			insertSide(v);
+			break;
+		case VertexType::RegularRight:
+		{
+			const size_t left = leftSide(v);
+			if (left != cNoVertex)
+			{
+				connectMergeHelper(left, v);
+				helpers[left] = v;
+			}
+			break;
+		}
+		}
+	}
+}
+
+void PolygonTriangulation::addDiagonal(size_t a, size_t b)
+{
+	mDiagonals.emplace_back(a, b);
+}
+
+void PolygonTriangulation::splitMonotones()
+{
+	const size_t n = mVertexCount;
+	const size_t firstDiagonal = n;
+	auto twin = [&](size_t e) { return firstDiagonal + ((e - firstDiagonal) ^ 1); };
+	auto link = [&](size_t e, size_t next)
+	{
+		mEdges[e].next_offset = static_cast<ptrdiff_t>(next) - static_cast<ptrdiff_t>(e);
+		mEdges[next].prev_offset = static_cast<ptrdiff_t>(e) - static_cast<ptrdiff_t>(next);
+	};
+
+	// Each diagonal becomes two opposite edges
+	mEdges.resize(n + 2 * mDiagonals.size());
+	for (size_t k = 0; k < mDiagonals.size(); k++)
+	{
+		const size_t a = mDiagonals[k].first;
+		const size_t b = mDiagonals[k].second;
+		mEdges[n + 2 * k] = Edge{ 0, 0, mEdges[a].pid, a };
+		mEdges[n + 2 * k + 1] = Edge{ 0, 0, mEdges[b].pid, b };
+	}
+
+	// Diagonal edges grouped by their start vertex
+	std::vector<size_t> outgoingBegin(n + 1, 0);
+	for (size_t e = firstDiagonal; e < mEdges.size(); e++)
+	{
+		outgoingBegin[mEdges[e].id + 1]++;
+	}
+	std::partial_sum(outgoingBegin.begin(), outgoingBegin.end(), outgoingBegin.begin());
+	std::vector<size_t> outgoing(mEdges.size() - firstDiagonal);
+	{
+		std::vector<size_t> cursor(outgoingBegin.begin(), outgoingBegin.end() - 1);
+		for (size_t e = firstDiagonal; e < mEdges.size(); e++)
+		{
+			outgoing[cursor[mEdges[e].id]++] = e;
+		}
+	}
+
+	for (size_t v = 0; v < n; v++)
+	{
+		const size_t begin = outgoingBegin[v];
+		const size_t end = outgoingBegin[v + 1];
+		if (begin == end)
+		{
+			link(prevVertex(v), v);
+			continue;
+		}
+
+		// Counter-clockwise from the side leaving v, all diagonals lie in the
+		// interior angle which ends at the side coming in
+		const Vector2f origin = vertex(v);
+		const Vector2f reference = vertex(nextVertex(v));
+		auto target = [&](size_t e) { return vertex(mEdges[twin(e)].id); };
+		auto half = [&](const Vector2f& p) { return Predicates::orient2d(origin, reference, p) > 0 ? 0 : 1; };
+		std::sort(outgoing.begin() + begin, outgoing.begin() + end, [&](size_t a, size_t b)
+		{
+			const Vector2f pa = target(a);
+			const Vector2f pb = target(b);
+			const int halfA = half(pa);
+			const int halfB = half(pb);
+			if (halfA != halfB)
+			{
+				return halfA < halfB;
+			}
+			return Predicates::orient2d(origin, pa, pb) > 0;
+		});
+
+		// An edge coming in continues with the outgoing one clockwise next to it
+		link(prevVertex(v), outgoing[end - 1]);
+		link(twin(outgoing[begin]), v);
+		for (size_t i = begin + 1; i < end; i++)
+		{
+			link(twin(outgoing[i]), outgoing[i - 1]);
+		}
+	}
+
+	std::vector<bool> visited(mEdges.size(), false);
+	for (size_t e = 0; e < mEdges.size(); e++)
+	{
+		if (visited[e])
+		{
+			continue;
+		}
+		MonotonePolygon monotone;
+		monotone.mEdge = &mEdges[e];
+		const Edge* edge = monotone.mEdge;
+		do
+		{
+			visited[edge - mEdges.data()] = true;
+			edge = edge->next();
+		} while (edge != monotone.mEdge);
+		mMonotones.push_back(monotone);
+	}
+}
+
+void PolygonTriangulation::triangulateMonotones()
+{
+	// Every hole adds two triangles
+	mTriangles.reserve(3 * (mVertexCount + 2 * mHoleCount - 2));
+
+	// Reused across pieces
+	std::vector<size_t> loop;
+	// Vertices in sweep order, true for the left chain
+	std::vector<std::pair<size_t, bool>> sorted;
+	std::vector<size_t> stack;
+
+	for (const MonotonePolygon& monotone : mMonotones)
+	{
+		loop.clear();
+		const Edge* edge = monotone.mEdge;
+		do
+		{
+			loop.push_back(edge->id);
+			edge = edge->next();
+		} while (edge != monotone.mEdge);
+
+		const size_t m = loop.size();
+		if (m < 3)
+		{
+			continue;
+		}
+		if (m == 3)
+		{
+			addTriangle(loop[0], loop[1], loop[2]);
+			continue;
+		}
+
+		// Counter-clockwise from the top vertex goes down the left chain,
+		// merge it with the right chain into sweep order
+		size_t top = 0;
+		for (size_t i = 1; i < m; i++)
+		{
+			if (above(loop[i], loop[top]))
+			{
+				top = i;
+			}
+		}
+		sorted.clear();
+		sorted.emplace_back(loop[top], true);
+		size_t left = (top + 1) % m;
+		size_t right = (top + m - 1) % m;
+		while (left != right)
+		{
+			if (above(loop[left], loop[right]))
+			{
+				sorted.emplace_back(loop[left], true);
+				left = (left + 1) % m;
+			}
+			else
+			{
+				sorted.emplace_back(loop[right], false);
+				right = (right + m - 1) % m;
+			}
+		}
+		sorted.emplace_back(loop[left], false);
+
+		stack.assign({ 0, 1 });
+		for (size_t j = 2; j + 1 < m; j++)
+		{
+			const size_t u = sorted[j].first;
+			const bool onLeft = sorted[j].second;
+			if (onLeft != sorted[stack.back()].second)
+			{
+				// Opposite chains, u sees the whole stack
+				for (size_t k = 0; k + 1 < stack.size(); k++)
+				{
+					addTriangle(sorted[stack[k]].first, sorted[stack[k + 1]].first, u);
+				}
+				stack.assign({ j - 1, j });
+				continue;
+			}
+
+			// Same chain, cut off the convex corners u sees
+			size_t last = stack.back();
+			stack.pop_back();
+			while (!stack.empty())
+			{
+				const size_t s = sorted[stack.back()].first;
+				const double turn = Predicates::orient2d(vertex(s), vertex(sorted[last].first), vertex(u));
+				if (onLeft ? turn <= 0 : turn >= 0)
+				{
+					break;
+				}
+				addTriangle(s, sorted[last].first, u);
+				last = stack.back();
+				stack.pop_back();
+			}
+			stack.push_back(last);
+			stack.push_back(j);
+		}
+
+		const size_t bottom = sorted[m - 1].first;
+		for (size_t k = 0; k + 1 < stack.size(); k++)
+		{
+			addTriangle(sorted[stack[k]].first, sorted[stack[k + 1]].first, bottom);
+		}
+	}
+}
+
+void PolygonTriangulation::clipEars()
+{
+	const size_t n = mVertexCount;
+	mTriangles.reserve(3 * (n - 2));
+
+	// Remaining polygon as a linked ring
+	std::vector<size_t>& prev = mEarPrev;
+	std::vector<size_t>& next = mEarNext;
+	prev.resize(n);
+	next.resize(n);
+	for (size_t v = 0; v < n; v++)
+	{
+		prev[v] = prevVertex(v);
+		next[v] = nextVertex(v);
+	}
+	auto convex = [&](size_t v)
+	{
+		return Predicates::orient2d(vertex(prev[v]), vertex(v), vertex(next[v])) > 0;
+	};
+
+	// Z-order codes on a 2^16 grid over the bounding box, monotone in x and y,
+	// so everything inside a box has a code between those of its corners
+	Vector2f minP = vertex(0);
+	Vector2f maxP = minP;
+	for (size_t v = 1; v < n; v++)
+	{
+		const Vector2f p = vertex(v);
+		minP.x = std::min(minP.x, p.x);
+		minP.y = std::min(minP.y, p.y);
+		maxP.x = std::max(maxP.x, p.x);
+		maxP.y = std::max(maxP.y, p.y);
+	}
+	const float cGridMax = 65535.0f;
+	const float extent = std::max(maxP.x - minP.x, maxP.y - minP.y);
+	const float scale = extent > 0 ? cGridMax / extent : 0.0f;
+	auto zCode = [&](const Vector2f& p)
+	{
+		uint32_t gx = static_cast<uint32_t>(std::min((p.x - minP.x) * scale, cGridMax));
+		uint32_t gy = static_cast<uint32_t>(std::min((p.y - minP.y) * scale, cGridMax));
+		return Utils::mortonIndex(gx, gy);
+	};
+
+	// Only reflex vertices can lie in an ear, clipping never makes a vertex reflex,
+	// so the sorted list only loses entries, which are flagged instead of erased
+	std::vector<Utils::KeyedId<uint32_t>>& reflex = mReflex;
+	std::vector<bool>& isReflex = mIsReflex;
+	reflex.clear();
+	isReflex.assign(n, false);
+	for (size_t v = 0; v < n; v++)
+	{
+		if (!convex(v))
+		{
+			reflex.push_back({ zCode(vertex(v)), v });
+			isReflex[v] = true;
+		}
+	}
+	Utils::radixSort(reflex);
+
+	auto isEar = [&](size_t v)
+	{
+		if (isReflex[v] || !convex(v))
+		{
+			return false;
+		}
+		const size_t a = prev[v];
+		const size_t c = next[v];
+		const Vector2f pa = vertex(a);
+		const Vector2f pb = vertex(v);
+		const Vector2f pc = vertex(c);
+		const Vector2f boxMin(std::min({ pa.x, pb.x, pc.x }), std::min({ pa.y, pb.y, pc.y }));
+		const Vector2f boxMax(std::max({ pa.x, pb.x, pc.x }), std::max({ pa.y, pb.y, pc.y }));
+		const uint32_t maxCode = zCode(boxMax);
+		auto it = std::lower_bound(reflex.begin(), reflex.end(), zCode(boxMin),
+								   [](const Utils::KeyedId<uint32_t>& r, uint32_t code) { return r.key < code; });
+		for (; it != reflex.end() && it->key <= maxCode; ++it)
+		{
+			const size_t r = it->id;
+			if (!isReflex[r] || r == a || r == c)
+			{
+				continue;
+			}
+			const Vector2f p = vertex(r);
+			if (p.x < boxMin.x || p.y < boxMin.y || p.x > boxMax.x || p.y > boxMax.y)
+			{
+				continue;
+			}
+			if (Predicates::orient2d(pa, pb, p) >= 0
+				&& Predicates::orient2d(pb, pc, p) >= 0
+				&& Predicates::orient2d(pc, pa, p) >= 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// A full round without an ear only happens for degenerate input,
+	// the current corner is clipped anyway so the loop always ends
+	size_t remaining = n;
+	size_t v = 0;
+	size_t misses = 0;
+	while (remaining > 3)
+	{
+		if (!isEar(v) && misses < remaining)
+		{
+			v = next[v];
+			misses++;
+			continue;
+		}
+
+		const size_t a = prev[v];
+		const size_t c = next[v];
+		addTriangle(a, v, c);
+		next[a] = c;
+		prev[c] = a;
+		isReflex[v] = false;
+		remaining--;
+		if (isReflex[a] && convex(a))
+		{
+			isReflex[a] = false;
+		}
+		if (isReflex[c] && convex(c))
+		{
+			isReflex[c] = false;
+		}
+		v = c;
+		misses = 0;
+	}
+	addTriangle(prev[v], v, next[v]);
+}
+
+void PolygonTriangulation::addTriangle(size_t a, size_t b, size_t c)
+{
+	if (Predicates::orient2d(vertex(a), vertex(b), vertex(c)) < 0)
+	{
+		std::swap(b, c);
+	}
+	mTriangles.push_back(static_cast<uint32_t>(mEdges[a].pid));
+	mTriangles.push_back(static_cast<uint32_t>(mEdges[b].pid));
+	mTriangles.push_back(static_cast<uint32_t>(mEdges[c].pid));
+}
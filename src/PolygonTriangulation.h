@@ -1,31 +1,142 @@
 #pragma once
 
 #include "Vector2.h"
+#include "PointSet.h"
+#include "Predicates.h"
+#include "RadixSort.h"
 
+#include <set>
 
+// Triangulation of a simple polygon given by its vertices in order, either orientation
+// Holes are further rings of the same point set, see ringOffsets
 class PolygonTriangulation
 {
 public:
+	enum class Algorithm
+	{
+		Auto,				// Ear clipping below cEarClippingMaxSize vertices, monotone partition above
+		MonotonePartition,	// A plane sweep from top to bottom adds the diagonals that split
+							// the polygon into y-monotone pieces, each piece is then
+							// triangulated in linear time, O(n log n) overall
+		EarClipping			// Clips convex corners which contain no reflex vertex, reflex vertices
+							// are looked up by z-order, little setup but O(n^2) in the worst case,
+							// polygons with holes always use the sweep
+	};
+	static const size_t cEarClippingMaxSize = 64;
+
+	// Half-edge on the boundary of a piece, which lies on its left
+	// The first n edges are the polygon sides, edge i starts at polygon vertex i,
+	// outer ring counter-clockwise and holes clockwise, the diagonals follow
+	// in pairs of opposite edges
 	struct Edge
 	{
 		ptrdiff_t prev_offset, next_offset;
+		// Input point the edge starts at
 		size_t pid;
+		// Polygon vertex the edge starts at, rings follow each other in input order
 		size_t id;
+
+		const Edge* prev() const { return this + prev_offset; }
+		const Edge* next() const { return this + next_offset; }
 	};
 	struct MonotonePolygon
 	{
 		const Edge* mEdge = nullptr;
 	};
 
-	PolygonTriangulation(std::vector<Vector2f> &points);
+	PolygonTriangulation(PointSet &&points, Algorithm algorithm = Algorithm::Auto);
+	PolygonTriangulation(std::vector<Vector2f> &points, Algorithm algorithm = Algorithm::Auto);
+	PolygonTriangulation(Vector2SoA &points, Algorithm algorithm = Algorithm::Auto);
+	// ringOffsets holds the first point of each ring in ascending order, the ring at 0 is
+	// the outer boundary and the others are holes inside it, rings may not cross or touch
+	PolygonTriangulation(PointSet &&points, const std::vector<size_t> &ringOffsets, Algorithm algorithm = Algorithm::Auto);
+	PolygonTriangulation(std::vector<Vector2f> &points, const std::vector<size_t> &ringOffsets, Algorithm algorithm = Algorithm::Auto);
+	PolygonTriangulation(Vector2SoA &points, const std::vector<size_t> &ringOffsets, Algorithm algorithm = Algorithm::Auto);
 	~PolygonTriangulation();
 
+	// Triangulates many polygons stored back to back, ringOffsets holds the first point of
+	// every ring and polygonOffsets the first ring of every polygon, which is its outer boundary
+	// Polygon i writes its triangles as ids into points to indices[indexOffsets[i], indexOffsets[i + 1]),
+	// 3 (n + 2h - 2) of them for n vertices and h holes, padded with degenerate ones for invalid input
+	// threadCount == 0 uses all hardware threads, each one reuses a single set of buffers
+	static void triangulateBatch(const std::vector<Vector2f> &points,
+								 const std::vector<size_t> &ringOffsets,
+								 const std::vector<size_t> &polygonOffsets,
+								 std::vector<uint32_t> &indices,
+								 std::vector<size_t> &indexOffsets,
+								 Algorithm algorithm = Algorithm::Auto,
+								 size_t threadCount = 0);
+
+	// Counter-clockwise triangles, three point ids each
+	void extractTriangleIndices(std::vector<uint32_t> &indices) const;
+	// Sides and diagonals of the triangulation, two point ids per line
 	void getLineIndexBuffer(std::vector<uint32_t> &indices) const;
-	const Vector2f* vertexData() const { return mPoints.data(); }
+	// Empty when the polygon was ear clipped
+	const std::vector<MonotonePolygon>& monotonePolygons() const { return mMonotones; }
+	// nullptr when the input was given as SoA
+	const Vector2f* vertexData() const { return mPoints.aosData(); }
 
 private:
-	std::vector<Vector2f> mPoints;
+	enum class VertexType : uint8_t
+	{
+		Start, End, Split, Merge, RegularLeft, RegularRight
+	};
+
+	// Orders the sides in the sweep status from left to right,
+	// points are looked up against them directly
+	struct SweepLess
+	{
+		using is_transparent = void;
+		const PolygonTriangulation* self;
+
+		bool operator()(size_t a, size_t b) const;
+		bool operator()(size_t side, const Vector2f& p) const;
+		bool operator()(const Vector2f& p, size_t side) const;
+	};
+	using SweepStatus = std::multiset<size_t, SweepLess>;
+
+	// Polygons of a batch are run one after another through the same object
+	PolygonTriangulation();
+	void triangulate(PointSet &&points, const std::vector<size_t> &ringOffsets, Algorithm algorithm);
+
+	void initEdges(const std::vector<size_t> &ringOffsets);
+	void sortEvents();
+	VertexType classify(size_t v) const;
+	void partition();
+	void addDiagonal(size_t a, size_t b);
+	// Links the diagonals into the edge loops and collects the pieces
+	void splitMonotones();
+	void triangulateMonotones();
+	void clipEars();
+	// Polygon vertices, emitted counter-clockwise
+	void addTriangle(size_t a, size_t b, size_t c);
+
+	Vector2f vertex(size_t v) const { return mPoints[mEdges[v].pid]; }
+	// Neighbours along the ring of v
+	size_t nextVertex(size_t v) const { return mNextVertex[v]; }
+	size_t prevVertex(size_t v) const { return mPrevVertex[v]; }
+	// Sweep order, top to bottom then left to right
+	bool above(size_t a, size_t b) const { return mEventRank[a] < mEventRank[b]; }
+
+private:
+	PointSet mPoints;
+	size_t mVertexCount;
+	size_t mHoleCount;
 	std::vector<Edge> mEdges;
+	std::vector<size_t> mNextVertex;
+	std::vector<size_t> mPrevVertex;
 	std::vector<MonotonePolygon> mMonotones;
-};
 
+	// Polygon vertices in sweep order and the position of each one in it
+	std::vector<size_t> mEvents;
+	std::vector<size_t> mEventRank;
+	// Pairs of polygon vertices
+	std::vector<std::pair<size_t, size_t>> mDiagonals;
+	std::vector<uint32_t> mTriangles;
+
+	// Remaining ring and reflex vertices by z-order while clipping ears
+	std::vector<size_t> mEarPrev;
+	std::vector<size_t> mEarNext;
+	std::vector<Utils::KeyedId<uint32_t>> mReflex;
+	std::vector<bool> mIsReflex;
+};
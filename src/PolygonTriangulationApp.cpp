@@ -1,4 +1,4 @@
-#include "ConvexHullApp.h"
+#include "PolygonTriangulationApp.h"
 
 
 void resetPoints()
@@ -19,23 +19,24 @@ void resetPoints()
 
 	std::random_device rd;  //Will be used to obtain a seed for the random number engine
 	std::mt19937 gen(rd()); //Standard mersenne_twister_engine seeded with rd()
-	std::uniform_real_distribution<> dis(-0.8, 0.8);
+	std::uniform_real_distribution<> dis(0.0, 1.0);
 
+	// Star-shaped polygon, one vertex per angular slot at a random radius
 	for (size_t i = 0; i < pointCount; i++)
 	{
-		pts.emplace_back(dis(gen), dis(gen));
+		double angle = (i + dis(gen)) / pointCount * 6.283185307179586;
+		double radius = 0.2 + 0.6 * dis(gen);
+		pts.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
 	}
 
 	triangulationPtr.reset(new PolygonTriangulation(pts));
-	triangulationPtr->extractLineSegmentIndices(ptIndices);
+	triangulationPtr->getLineIndexBuffer(ptIndices);
 }
 
 int main(int argc, char* argv[])
 {
 	std::cout << "Operations:\n"
-		"\tLeft Mouse Button: Move forward step by step\n"\
-		"\tENTER: Finish constructing Convex Hull\n"\
-		"\tR: Reset points\n"\
+		"\tR: Reset polygon\n"\
 		"\n";
 
 	resetPoints();
@@ -50,7 +51,7 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	window = glfwCreateWindow(winSize, winSize, "Convex Hull", nullptr, nullptr);
+	window = glfwCreateWindow(winSize, winSize, "Polygon Triangulation", nullptr, nullptr);
 	if (!window)
 	{
 		fprintf(stderr, "ERROR: could not open window with GLFW3\n");
@@ -59,7 +60,6 @@ int main(int argc, char* argv[])
 	}
 	glfwMakeContextCurrent(window);
 	//glfwSetCursorPosCallback(window, cursor_position_callback);
-	glfwSetMouseButtonCallback(window, mouse_button_callback);
 	glfwSetWindowSizeCallback(window, window_size_callback);
 	glfwSetWindowRefreshCallback(window, window_refresh_callback);
 	glfwSetKeyCallback(window, key_callback);
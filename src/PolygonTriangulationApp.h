@@ -47,37 +47,15 @@ void updateIBO()
 
 void extractIndices(const PolygonTriangulation& mesh)
 {
-	mesh.extractLineSegmentIndices(ptIndices);
+	mesh.getLineIndexBuffer(ptIndices);
 	if (!ptIndices.empty())
 	{
 		updateIBO();
 	}
 }
 
-void mouse_button_callback(GLFWwindow* /*window*/, int button, int action, int /*mods*/)
-{
-	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
-	{
-		if (triangulationPtr)
-		{
-			triangulationPtr->advance();
-			extractIndices(*triangulationPtr);
-		}
-	}
-}
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-	if (key == GLFW_KEY_ENTER && action == GLFW_PRESS)
-	{
-		if (triangulationPtr)
-		{
-			while (triangulationPtr->advance())
-			{
-				extractIndices(*triangulationPtr);
-				window_refresh_callback(window);
-			}
-		}
-	}
 	if (key == GLFW_KEY_R && action == GLFW_PRESS)
 	{
 		resetPoints();
@@ -103,7 +81,7 @@ void window_refresh_callback(GLFWwindow* window)
 
 	glUseProgram(hullShaderProgram);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	glDrawElements(GL_LINE_LOOP, ptIndices.size(), GL_UNSIGNED_INT, 0);
+	glDrawElements(GL_LINES, ptIndices.size(), GL_UNSIGNED_INT, 0);
 
 	glUseProgram(vertShaderProgram);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_POINTS);
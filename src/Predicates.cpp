@@ -0,0 +1,317 @@
+#include "Predicates.h"
+
+namespace Predicates
+{
+
+namespace
+{
+
+// Machine epsilon as defined by Shewchuk, half ulp of 1.0
+const double cEpsilon = std::ldexp(1.0, -53);
+// Splits a double into two non-overlapping 26-bit halves
+const double cSplitter = std::ldexp(1.0, 27) + 1.0;
+
+const double cCcwErrBoundA = (3.0 + 16.0 * cEpsilon) * cEpsilon;
+const double cIccErrBoundA = (10.0 + 96.0 * cEpsilon) * cEpsilon;
+
+// Expansions are arrays of non-overlapping doubles in increasing magnitude,
+// the last component carries the sign of the exact sum
+
+inline void fastTwoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	double bVirtual = x - a;
+	y = b - bVirtual;
+}
+
+inline void twoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	double bVirtual = x - a;
+	double aVirtual = x - bVirtual;
+	double bRoundoff = b - bVirtual;
+	double aRoundoff = a - aVirtual;
+	y = aRoundoff + bRoundoff;
+}
+
+inline void split(double a, double& hi, double& lo)
+{
+	double c = cSplitter * a;
+	double aBig = c - a;
+	hi = c - aBig;
+	lo = a - hi;
+}
+
+inline void twoProduct(double a, double b, double& x, double& y)
+{
+	x = a * b;
+	double aHi, aLo, bHi, bLo;
+	split(a, aHi, aLo);
+	split(b, bHi, bLo);
+	double err1 = x - (aHi * bHi);
+	double err2 = err1 - (aLo * bHi);
+	double err3 = err2 - (aHi * bLo);
+	y = (aLo * bLo) - err3;
+}
+
+// a*b - c*d as a 4-component expansion
+inline void twoTwoProductDiff(double a, double b, double c, double d, double* h)
+{
+	double ab1, ab0, cd1, cd0;
+	twoProduct(a, b, ab1, ab0);
+	twoProduct(c, d, cd1, cd0);
+
+	// (ab1, ab0) - (cd1, cd0)
+	double i, j, k, l, m;
+	twoSum(ab0, -cd0, i, h[0]);
+	twoSum(ab1, i, j, k);
+	twoSum(k, -cd1, l, h[1]);
+	twoSum(j, l, m, h[2]);
+	h[3] = m;
+}
+
+// h = e + f, zero components eliminated, returns length of h
+int expansionSum(int eLen, const double* e, int fLen, const double* f, double* h)
+{
+	int eIdx = 0, fIdx = 0, hIdx = 0;
+	double eNow = e[0];
+	double fNow = f[0];
+	double q, qNew, hh;
+
+	if ((fNow > eNow) == (fNow > -eNow))
+	{
+		q = eNow;
+		eNow = ++eIdx < eLen ? e[eIdx] : 0.0;
+	}
+	else
+	{
+		q = fNow;
+		fNow = ++fIdx < fLen ? f[fIdx] : 0.0;
+	}
+
+	if (eIdx < eLen && fIdx < fLen)
+	{
+		if ((fNow > eNow) == (fNow > -eNow))
+		{
+			fastTwoSum(eNow, q, qNew, hh);
+			eNow = ++eIdx < eLen ? e[eIdx] : 0.0;
+		}
+		else
+		{
+			fastTwoSum(fNow, q, qNew, hh);
+			fNow = ++fIdx < fLen ? f[fIdx] : 0.0;
+		}
+		q = qNew;
+		if (hh != 0.0)
+		{
+			h[hIdx++] = hh;
+		}
+
+		while (eIdx < eLen && fIdx < fLen)
+		{
+			if ((fNow > eNow) == (fNow > -eNow))
+			{
+				twoSum(q, eNow, qNew, hh);
+				eNow = ++eIdx < eLen ? e[eIdx] : 0.0;
+			}
+			else
+			{
+				twoSum(q, fNow, qNew, hh);
+				fNow = ++fIdx < fLen ? f[fIdx] : 0.0;
+			}
+			q = qNew;
+			if (hh != 0.0)
+			{
+				h[hIdx++] = hh;
+			}
+		}
+	}
+
+	while (eIdx < eLen)
+	{
+		twoSum(q, eNow, qNew, hh);
+		eNow = ++eIdx < eLen ? e[eIdx] : 0.0;
+		q = qNew;
+		if (hh != 0.0)
+		{
+			h[hIdx++] = hh;
+		}
+	}
+	while (fIdx < fLen)
+	{
+		twoSum(q, fNow, qNew, hh);
+		fNow = ++fIdx < fLen ? f[fIdx] : 0.0;
+		q = qNew;
+		if (hh != 0.0)
+		{
+			h[hIdx++] = hh;
+		}
+	}
+
+	if (q != 0.0 || hIdx == 0)
+	{
+		h[hIdx++] = q;
+	}
+	return hIdx;
+}
+
+// h = b * e, zero components eliminated, returns length of h
+int scaleExpansion(int eLen, const double* e, double b, double* h)
+{
+	int hIdx = 0;
+	double q, hh;
+	twoProduct(e[0], b, q, hh);
+	if (hh != 0.0)
+	{
+		h[hIdx++] = hh;
+	}
+
+	for (int eIdx = 1; eIdx < eLen; eIdx++)
+	{
+		double product1, product0, sum;
+		twoProduct(e[eIdx], b, product1, product0);
+		twoSum(q, product0, sum, hh);
+		if (hh != 0.0)
+		{
+			h[hIdx++] = hh;
+		}
+		fastTwoSum(product1, sum, q, hh);
+		if (hh != 0.0)
+		{
+			h[hIdx++] = hh;
+		}
+	}
+
+	if (q != 0.0 || hIdx == 0)
+	{
+		h[hIdx++] = q;
+	}
+	return hIdx;
+}
+
+double orient2dExact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	double aTerms[4], bTerms[4], cTerms[4];
+	twoTwoProductDiff(ax, by, ax, cy, aTerms);
+	twoTwoProductDiff(bx, cy, bx, ay, bTerms);
+	twoTwoProductDiff(cx, ay, cx, by, cTerms);
+
+	double v[8], w[12];
+	int vLen = expansionSum(4, aTerms, 4, bTerms, v);
+	int wLen = expansionSum(vLen, v, 4, cTerms, w);
+	return w[wLen - 1];
+}
+
+// lift(p) * det as an expansion, returns length of h
+int liftScale(int detLen, const double* det, double px, double py, double* h)
+{
+	double det24x[24], det48x[48], det24y[24], det48y[48];
+	int xLen = scaleExpansion(detLen, det, px, det24x);
+	xLen = scaleExpansion(xLen, det24x, px, det48x);
+	int yLen = scaleExpansion(detLen, det, py, det24y);
+	yLen = scaleExpansion(yLen, det24y, py, det48y);
+	return expansionSum(xLen, det48x, yLen, det48y, h);
+}
+
+double inCircleExact(const double* pa, const double* pb, const double* pc, const double* pd)
+{
+	double ab[4], bc[4], cd[4], da[4], ac[4], bd[4];
+	twoTwoProductDiff(pa[0], pb[1], pb[0], pa[1], ab);
+	twoTwoProductDiff(pb[0], pc[1], pc[0], pb[1], bc);
+	twoTwoProductDiff(pc[0], pd[1], pd[0], pc[1], cd);
+	twoTwoProductDiff(pd[0], pa[1], pa[0], pd[1], da);
+	twoTwoProductDiff(pa[0], pc[1], pc[0], pa[1], ac);
+	twoTwoProductDiff(pb[0], pd[1], pd[0], pb[1], bd);
+
+	// Orientation of each triple of points
+	double temp8[8], cda[12], dab[12], abc[12], bcd[12];
+	int tempLen = expansionSum(4, cd, 4, da, temp8);
+	int cdaLen = expansionSum(tempLen, temp8, 4, ac, cda);
+	tempLen = expansionSum(4, da, 4, ab, temp8);
+	int dabLen = expansionSum(tempLen, temp8, 4, bd, dab);
+	for (int i = 0; i < 4; i++)
+	{
+		bd[i] = -bd[i];
+		ac[i] = -ac[i];
+	}
+	tempLen = expansionSum(4, ab, 4, bc, temp8);
+	int abcLen = expansionSum(tempLen, temp8, 4, ac, abc);
+	tempLen = expansionSum(4, bc, 4, cd, temp8);
+	int bcdLen = expansionSum(tempLen, temp8, 4, bd, bcd);
+
+	// Expand along the lifted column, signs alternate
+	for (int i = 0; i < cdaLen; i++)
+	{
+		cda[i] = -cda[i];
+	}
+	for (int i = 0; i < abcLen; i++)
+	{
+		abc[i] = -abc[i];
+	}
+	double aDet[96], bDet[96], cDet[96], dDet[96];
+	int aLen = liftScale(bcdLen, bcd, pa[0], pa[1], aDet);
+	int bLen = liftScale(cdaLen, cda, pb[0], pb[1], bDet);
+	int cLen = liftScale(dabLen, dab, pc[0], pc[1], cDet);
+	int dLen = liftScale(abcLen, abc, pd[0], pd[1], dDet);
+
+	double abDet[192], cdDet[192], det[384];
+	int abLen = expansionSum(aLen, aDet, bLen, bDet, abDet);
+	int cdLen = expansionSum(cLen, cDet, dLen, dDet, cdDet);
+	int detLen = expansionSum(abLen, abDet, cdLen, cdDet, det);
+	return det[detLen - 1];
+}
+
+}
+
+double orient2d(const Vector2f& a, const Vector2f& b, const Vector2f& c)
+{
+	double detLeft = (double(a.x) - c.x) * (double(b.y) - c.y);
+	double detRight = (double(a.y) - c.y) * (double(b.x) - c.x);
+	double det = detLeft - detRight;
+
+	// Fast filter
+	double detSum = std::abs(detLeft) + std::abs(detRight);
+	double errBound = cCcwErrBoundA * detSum;
+	if (det >= errBound || -det >= errBound)
+	{
+		return det;
+	}
+
+	return orient2dExact(a.x, a.y, b.x, b.y, c.x, c.y);
+}
+
+double inCircle(const Vector2f& a, const Vector2f& b, const Vector2f& c, const Vector2f& d)
+{
+	double adx = double(a.x) - d.x, ady = double(a.y) - d.y;
+	double bdx = double(b.x) - d.x, bdy = double(b.y) - d.y;
+	double cdx = double(c.x) - d.x, cdy = double(c.y) - d.y;
+
+	double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+	double cdxady = cdx * ady, adxcdy = adx * cdy;
+	double adxbdy = adx * bdy, bdxady = bdx * ady;
+	double aLift = adx * adx + ady * ady;
+	double bLift = bdx * bdx + bdy * bdy;
+	double cLift = cdx * cdx + cdy * cdy;
+
+	double det = aLift * (bdxcdy - cdxbdy) +
+		bLift * (cdxady - adxcdy) +
+		cLift * (adxbdy - bdxady);
+
+	// Fast filter
+	double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * aLift +
+		(std::abs(cdxady) + std::abs(adxcdy)) * bLift +
+		(std::abs(adxbdy) + std::abs(bdxady)) * cLift;
+	double errBound = cIccErrBoundA * permanent;
+	if (det > errBound || -det > errBound)
+	{
+		return det;
+	}
+
+	const double pa[2]{ a.x, a.y };
+	const double pb[2]{ b.x, b.y };
+	const double pc[2]{ c.x, c.y };
+	const double pd[2]{ d.x, d.y };
+	return inCircleExact(pa, pb, pc, pd);
+}
+
+}
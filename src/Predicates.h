@@ -0,0 +1,19 @@
+#pragma once
+#include "Vector2.h"
+
+// Adaptive-precision geometric predicates after Shewchuk,
+// "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates"
+// A floating-point filter decides the sign in the common case,
+// exact expansion arithmetic only runs when the filter is inconclusive
+namespace Predicates
+{
+
+// Positive if a, b, c are in counter-clockwise order,
+// negative if clockwise, zero if collinear
+double orient2d(const Vector2f& a, const Vector2f& b, const Vector2f& c);
+
+// Positive if d lies inside the circle through counter-clockwise a, b, c,
+// negative if outside, zero if cocircular
+double inCircle(const Vector2f& a, const Vector2f& b, const Vector2f& c, const Vector2f& d);
+
+}
@@ -0,0 +1,151 @@
+#include "RadixSort.h"
+
+namespace Utils
+{
+
+namespace
+{
+
+// 2^11 counters still fit in L1, 64-bit keys take 6 passes instead of 8
+const size_t cRadixBits = 11;
+const size_t cBucketCount = size_t(1) << cRadixBits;
+// Below this a comparison sort beats clearing and scanning the histograms
+const size_t cMinRadixSize = 1024;
+// Chunks smaller than this are not worth a thread
+const size_t cMinChunkSize = 1 << 16;
+
+using Histogram = std::array<size_t, cBucketCount>;
+
+template <typename KeyT>
+size_t digit(KeyT key, size_t pass)
+{
+	return static_cast<size_t>(key >> (pass * cRadixBits)) & (cBucketCount - 1);
+}
+
+template <typename KeyT>
+void radixSortImpl(std::vector<KeyedId<KeyT>>& items, size_t threadCount)
+{
+	const size_t count = items.size();
+	if (count < cMinRadixSize)
+	{
+		std::stable_sort(items.begin(), items.end(), [](const KeyedId<KeyT>& a, const KeyedId<KeyT>& b)
+		{
+			return a.key < b.key;
+		});
+		return;
+	}
+
+	const size_t passCount = (sizeof(KeyT) * 8 + cRadixBits - 1) / cRadixBits;
+	const size_t chunkCount = std::max<size_t>(1, std::min(threadCount, count / cMinChunkSize));
+	const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+	// Runs work(chunk, first, last) for every chunk, on its own thread if there are several
+	auto forEachChunk = [&](auto work)
+	{
+		if (chunkCount == 1)
+		{
+			work(0, 0, count);
+			return;
+		}
+		std::vector<std::future<void>> tasks;
+		for (size_t chunk = 1; chunk < chunkCount; chunk++)
+		{
+			const size_t first = chunk * chunkSize;
+			tasks.push_back(std::async(std::launch::async, work, chunk, first, std::min(first + chunkSize, count)));
+		}
+		work(0, 0, std::min(chunkSize, count));
+		for (auto& task : tasks)
+		{
+			task.get();
+		}
+	};
+
+	// Histograms of every digit in one read, to find the passes that would not move anything
+	std::vector<std::vector<Histogram>> histograms(chunkCount, std::vector<Histogram>(passCount));
+	forEachChunk([&](size_t chunk, size_t first, size_t last)
+	{
+		std::vector<Histogram>& chunkHistograms = histograms[chunk];
+		for (Histogram& histogram : chunkHistograms)
+		{
+			histogram.fill(0);
+		}
+		for (size_t i = first; i < last; i++)
+		{
+			for (size_t pass = 0; pass < passCount; pass++)
+			{
+				chunkHistograms[pass][digit(items[i].key, pass)]++;
+			}
+		}
+	});
+
+	std::vector<KeyedId<KeyT>> buffer(count);
+	std::vector<Histogram> offsets(chunkCount);
+	bool moved = false;
+	for (size_t pass = 0; pass < passCount; pass++)
+	{
+		bool trivial = false;
+		for (size_t bucket = 0; bucket < cBucketCount && !trivial; bucket++)
+		{
+			size_t bucketSize = 0;
+			for (size_t chunk = 0; chunk < chunkCount; chunk++)
+			{
+				bucketSize += histograms[chunk][pass][bucket];
+			}
+			trivial = bucketSize == count;
+		}
+		if (trivial)
+		{
+			continue;
+		}
+
+		// The counts per chunk are stale once a pass moved items between chunks
+		if (moved && chunkCount > 1)
+		{
+			forEachChunk([&](size_t chunk, size_t first, size_t last)
+			{
+				Histogram& histogram = histograms[chunk][pass];
+				histogram.fill(0);
+				for (size_t i = first; i < last; i++)
+				{
+					histogram[digit(items[i].key, pass)]++;
+				}
+			});
+		}
+
+		// Bucket b of chunk c starts after all smaller buckets and after bucket b of earlier chunks
+		size_t total = 0;
+		for (size_t bucket = 0; bucket < cBucketCount; bucket++)
+		{
+			for (size_t chunk = 0; chunk < chunkCount; chunk++)
+			{
+				offsets[chunk][bucket] = total;
+				total += histograms[chunk][pass][bucket];
+			}
+		}
+
+		forEachChunk([&](size_t chunk, size_t first, size_t last)
+		{
+			Histogram& offset = offsets[chunk];
+			for (size_t i = first; i < last; i++)
+			{
+				buffer[offset[digit(items[i].key, pass)]++] = items[i];
+			}
+		});
+		items.swap(buffer);
+		moved = true;
+	}
+}
+
+}
+
+void radixSort(std::vector<KeyedId<uint32_t>>& items, size_t threadCount)
+{
+	radixSortImpl(items, threadCount);
+}
+
+void radixSort(std::vector<KeyedId<uint64_t>>& items, size_t threadCount)
+{
+	radixSortImpl(items, threadCount);
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Vector2.h"
+
+#include <cstring>
+
+namespace Utils
+{
+
+// Unsigned bits of a float in the same order as the float, -0 and +0 share one key
+inline uint32_t sortableBits(float value)
+{
+	if (value == 0.0f)
+	{
+		value = 0.0f;
+	}
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline float fromSortableBits(uint32_t bits)
+{
+	bits = (bits & 0x80000000u) ? (bits & 0x7FFFFFFFu) : ~bits;
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// x in the high half, y in the low half, keys sort by x then y
+inline uint64_t lexicographicKey(const Vector2f& p)
+{
+	return (static_cast<uint64_t>(sortableBits(p.x)) << 32) | sortableBits(p.y);
+}
+
+inline Vector2f fromLexicographicKey(uint64_t key)
+{
+	return Vector2f(fromSortableBits(static_cast<uint32_t>(key >> 32)),
+					fromSortableBits(static_cast<uint32_t>(key)));
+}
+
+template <typename KeyT>
+struct KeyedId
+{
+	KeyT key;
+	size_t id;
+};
+
+// Stable LSD radix sort by key, one pass per 11-bit digit of the key
+// Passes over a digit all keys share are skipped
+// threadCount > 1 counts and scatters contiguous chunks of large inputs concurrently,
+// the result is the same for any thread count
+void radixSort(std::vector<KeyedId<uint32_t>>& items, size_t threadCount = 1);
+void radixSort(std::vector<KeyedId<uint64_t>>& items, size_t threadCount = 1);
+
+}
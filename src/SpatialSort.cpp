@@ -0,0 +1,74 @@
+#include "SpatialSort.h"
+#include "RadixSort.h"
+
+namespace Utils
+{
+
+void hilbertSort(const PointSet& points,
+				 std::vector<size_t>::iterator first,
+				 std::vector<size_t>::iterator last,
+				 size_t threadCount)
+{
+	if (last - first < 2)
+	{
+		return;
+	}
+
+	Vector2f minP = points[*first];
+	Vector2f maxP = minP;
+	for (auto it = first; it != last; ++it)
+	{
+		const Vector2f p = points[*it];
+		minP.x = std::min(minP.x, p.x);
+		minP.y = std::min(minP.y, p.y);
+		maxP.x = std::max(maxP.x, p.x);
+		maxP.y = std::max(maxP.y, p.y);
+	}
+
+	// Quantize into a 2^16 grid
+	const float cGridMax = 65535.0f;
+	float extent = std::max(maxP.x - minP.x, maxP.y - minP.y);
+	float scale = extent > 0 ? cGridMax / extent : 0.0f;
+
+	std::vector<KeyedId<uint32_t>> keys;
+	keys.reserve(last - first);
+	for (auto it = first; it != last; ++it)
+	{
+		const Vector2f p = points[*it];
+		uint32_t gx = static_cast<uint32_t>(std::min((p.x - minP.x) * scale, cGridMax));
+		uint32_t gy = static_cast<uint32_t>(std::min((p.y - minP.y) * scale, cGridMax));
+		keys.push_back({ hilbertIndex(gx, gy), *it });
+	}
+	radixSort(keys, threadCount);
+
+	for (auto& key : keys)
+	{
+		*first++ = key.id;
+	}
+}
+
+void brioOrder(const PointSet& points,
+			   std::vector<size_t>& outOrder,
+			   uint32_t seed)
+{
+	// Rounds smaller than this are not worth splitting further
+	const size_t cMinRoundSize = 64;
+
+	outOrder.resize(points.size());
+	std::iota(outOrder.begin(), outOrder.end(), 0);
+
+	std::mt19937 gen(seed);
+	std::shuffle(outOrder.begin(), outOrder.end(), gen);
+
+	// Last round holds half of the points, the one before a quarter, etc.
+	size_t roundEnd = outOrder.size();
+	while (roundEnd > cMinRoundSize)
+	{
+		size_t roundBegin = roundEnd / 2;
+		hilbertSort(points, outOrder.begin() + roundBegin, outOrder.begin() + roundEnd);
+		roundEnd = roundBegin;
+	}
+	hilbertSort(points, outOrder.begin(), outOrder.begin() + roundEnd);
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "Vector2.h"
+#include "PointSet.h"
+
+namespace Utils
+{
+
+// Position of a cell on the Hilbert curve filling a 2^order x 2^order grid
+inline uint32_t hilbertIndex(uint32_t x, uint32_t y, uint32_t order = 16)
+{
+	uint32_t n = 1u << order;
+	uint32_t d = 0;
+	for (uint32_t s = n / 2; s > 0; s /= 2)
+	{
+		uint32_t rx = (x & s) > 0;
+		uint32_t ry = (y & s) > 0;
+		d += s * s * ((3 * rx) ^ ry);
+
+		// Rotate quadrant
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+// Position of a cell on the Z-order curve filling a 2^16 x 2^16 grid,
+// x in the even bits, y in the odd ones
+inline uint32_t mortonIndex(uint32_t x, uint32_t y)
+{
+	auto spread = [](uint32_t v)
+	{
+		v &= 0xFFFF;
+		v = (v | (v << 8)) & 0x00FF00FF;
+		v = (v | (v << 4)) & 0x0F0F0F0F;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	};
+	return spread(x) | (spread(y) << 1);
+}
+
+// Sort point ids in [first, last) along the Hilbert curve of the bounding box of points
+// Ids in the same grid cell keep their order
+void hilbertSort(const PointSet& points,
+				 std::vector<size_t>::iterator first,
+				 std::vector<size_t>::iterator last,
+				 size_t threadCount = 1);
+
+// Biased Randomized Insertion Order
+// Shuffle point ids into rounds of doubling size,
+// each round is sorted along the Hilbert curve to keep consecutive points close
+void brioOrder(const PointSet& points,
+			   std::vector<size_t>& outOrder,
+			   uint32_t seed = 0);
+
+}
@@ -10,11 +10,18 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <queue>
+#include <deque>
 
 #include <algorithm>
 #include <numeric>
+#include <limits>
 #include <cassert>
 #include <memory>
 #include <random>
 
+#include <thread>
+#include <future>
+#include <mutex>
+#include <atomic>
+
 using namespace std;
\ No newline at end of file
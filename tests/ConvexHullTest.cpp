@@ -0,0 +1,249 @@
+// Graham scan against the plain comparison sort it replaced, on inputs with repeated points,
+// the ids every algorithm reports for them with culling and threads,
+// and Chan's algorithm against the monotone chain
+// Returns non-zero on the first mismatch
+
+#include "ConvexHull.h"
+
+#include <cstdio>
+#include <random>
+
+namespace
+{
+
+bool check(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", what);
+	}
+	return condition;
+}
+
+std::vector<uint32_t> grahamScan(std::vector<Vector2f> points)
+{
+	ConvexHull hull(points);
+	hull.process();
+	std::vector<uint32_t> indices;
+	hull.extractLineSegmentIndices(indices);
+	return indices;
+}
+
+// Comparison sort around the bottom point, copies of it first, then by angle
+// and distance, followed by the scan, coordinates of the hull in order
+std::vector<Vector2f> referenceHull(const std::vector<Vector2f>& points)
+{
+	std::vector<size_t> ids(points.size());
+	std::iota(ids.begin(), ids.end(), size_t(0));
+	auto bottom = std::min_element(ids.begin(), ids.end(), [&](size_t a, size_t b)
+	{
+		return points[a].y < points[b].y || (points[a].y == points[b].y && points[a].x < points[b].x);
+	});
+	std::iter_swap(ids.begin(), bottom);
+	const Vector2f origin = points[ids[0]];
+	std::sort(ids.begin() + 1, ids.end(), [&](size_t i, size_t j)
+	{
+		const Vector2f pi = points[i];
+		const Vector2f pj = points[j];
+		if (pi == origin || pj == origin)
+		{
+			return pi == origin && pj != origin;
+		}
+		const double side = Predicates::orient2d(origin, pi, pj);
+		if (side != 0)
+		{
+			return side > 0;
+		}
+		const double xi = double(pi.x) - origin.x, yi = double(pi.y) - origin.y;
+		const double xj = double(pj.x) - origin.x, yj = double(pj.y) - origin.y;
+		return xi * xi + yi * yi < xj * xj + yj * yj;
+	});
+
+	std::vector<size_t> stack{ ids[0], ids[1] };
+	for (size_t i = 2; i < ids.size();)
+	{
+		const Vector2f a = points[stack[stack.size() - 2]];
+		const Vector2f b = points[stack.back()];
+		const Vector2f p = points[ids[i]];
+		if (b != p && Predicates::orient2d(a, b, p) >= 0)
+		{
+			stack.push_back(ids[i++]);
+		}
+		else if (stack.size() > 2)
+		{
+			stack.pop_back();
+		}
+		else
+		{
+			stack.back() = ids[i++];
+		}
+	}
+
+	std::vector<Vector2f> hull;
+	for (size_t id : stack)
+	{
+		hull.push_back(points[id]);
+	}
+	return hull;
+}
+
+std::vector<uint32_t> hullIndices(std::vector<Vector2f> points, ConvexHull::Algorithm algorithm,
+								  ConvexHull::Culling culling, size_t threadCount)
+{
+	ConvexHull hull(points, algorithm, culling, threadCount);
+	hull.process();
+	std::vector<uint32_t> indices;
+	hull.extractLineSegmentIndices(indices);
+	return indices;
+}
+
+// Same ids with and without culling and for any thread count,
+// each one the smallest of its point not reported before
+bool reportsSmallestIds(const std::vector<Vector2f>& points, size_t threadCount)
+{
+	using Algorithm = ConvexHull::Algorithm;
+	using Culling = ConvexHull::Culling;
+	for (Algorithm algorithm : { Algorithm::GrahamScan, Algorithm::MonotoneChain, Algorithm::Chan })
+	{
+		const std::vector<uint32_t> indices = hullIndices(points, algorithm, Culling::None, 1);
+		if (hullIndices(points, algorithm, Culling::AklToussaint, 1) != indices
+			|| hullIndices(points, algorithm, Culling::None, threadCount) != indices
+			|| hullIndices(points, algorithm, Culling::AklToussaint, threadCount) != indices)
+		{
+			return false;
+		}
+
+		std::vector<bool> reported(points.size(), false);
+		for (uint32_t id : indices)
+		{
+			for (uint32_t other = 0; other < id; other++)
+			{
+				if (!reported[other] && points[other] == points[id])
+				{
+					return false;
+				}
+			}
+			reported[id] = true;
+		}
+	}
+	return true;
+}
+
+// Chan's algorithm gives the monotone chain's corners and ids
+bool chanMatchesMonotoneChain(const std::vector<Vector2f>& points)
+{
+	using Algorithm = ConvexHull::Algorithm;
+	for (ConvexHull::Culling culling : { ConvexHull::Culling::None, ConvexHull::Culling::AklToussaint })
+	{
+		if (hullIndices(points, Algorithm::Chan, culling, 1) != hullIndices(points, Algorithm::MonotoneChain, culling, 1))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool matchesReference(const std::vector<Vector2f>& points)
+{
+	const std::vector<uint32_t> indices = grahamScan(points);
+	std::vector<Vector2f> hull;
+	for (uint32_t id : indices)
+	{
+		hull.push_back(points[id]);
+	}
+	return hull == referenceHull(points);
+}
+
+}
+
+int main()
+{
+	bool ok = true;
+
+	// A copy of the bottom point stays right after it
+	ok &= check(grahamScan({ { 0, 0 }, { 2, 0 }, { 0, 0 }, { 2, 2 }, { 0, 2 }, { 1, 1 } })
+				== std::vector<uint32_t>{ 0, 2, 1, 3, 4 }, "bottom point copy, square");
+	ok &= check(grahamScan({ { 1, 0 }, { 0, 0 }, { 0, 0 }, { 2, 2 }, { -1, 1 } })
+				== std::vector<uint32_t>{ 1, 2, 0, 3, 4 }, "bottom point copy, quad");
+
+	std::mt19937 gen(1);
+	for (int round = 0; round < 50; round++)
+	{
+		// 100 points of a 5x5 grid, the bottom point and every hull point repeat
+		std::vector<Vector2f> grid;
+		for (int i = 0; i < 100; i++)
+		{
+			grid.emplace_back(float(gen() % 5), float(gen() % 5));
+		}
+		ok &= check(matchesReference(grid), "5x5 grid copies");
+		ok &= check(reportsSmallestIds(grid, 4), "5x5 grid copy ids");
+
+		// Random points with copies of the bottom point spread through them
+		std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+		std::vector<Vector2f> points;
+		for (int i = 0; i < 200; i++)
+		{
+			points.emplace_back(coord(gen), coord(gen));
+		}
+		const Vector2f bottom = *std::min_element(points.begin(), points.end(),
+			[](const Vector2f& a, const Vector2f& b) { return a.y < b.y || (a.y == b.y && a.x < b.x); });
+		for (int i = 0; i < 4; i++)
+		{
+			points.insert(points.begin() + gen() % points.size(), bottom);
+		}
+		ok &= check(matchesReference(points), "bottom point copies");
+	}
+
+	ok &= check(chanMatchesMonotoneChain({ { 1, 1 }, { 1, 1 }, { 1, 1 } }), "chan, one point repeated");
+	ok &= check(chanMatchesMonotoneChain({ { 0, 0 }, { 3, 3 }, { 1, 1 }, { 2, 2 }, { 3, 3 }, { 0, 0 } }),
+				"chan, collinear run");
+	ok &= check(chanMatchesMonotoneChain({ { 0, 0 }, { 4, 0 }, { 4, 4 }, { 0, 4 }, { 2, 0 }, { 4, 2 }, { 2, 4 }, { 0, 2 } }),
+				"chan, points on edges");
+	for (int round = 0; round < 10; round++)
+	{
+		// More points than one group holds, the hull ones repeated
+		std::vector<Vector2f> grid;
+		for (int i = 0; i < 1000; i++)
+		{
+			grid.emplace_back(float(gen() % 5), float(gen() % 5));
+		}
+		ok &= check(chanMatchesMonotoneChain(grid), "chan, 5x5 grid copies");
+
+		std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+		std::vector<Vector2f> points;
+		for (int i = 0; i < 5000; i++)
+		{
+			points.emplace_back(coord(gen), coord(gen));
+		}
+		ok &= check(chanMatchesMonotoneChain(points), "chan, random points");
+
+		// More hull vertices than the first group size guess, so wrapping restarts with larger groups
+		std::vector<Vector2f> circle;
+		for (int i = 0; i < 2000; i++)
+		{
+			const float a = float(gen() % 4096) * 6.28318531f / 4096;
+			circle.emplace_back(std::cos(a), std::sin(a));
+		}
+		ok &= check(chanMatchesMonotoneChain(circle), "chan, cocircular copies");
+
+		// Long collinear runs along the x axis and the diagonal
+		std::vector<Vector2f> lines;
+		for (int i = 0; i < 600; i++)
+		{
+			const float t = float(gen() % 300);
+			lines.emplace_back(i % 2 ? Vector2f(t, 0.0f) : Vector2f(t, t));
+		}
+		ok &= check(chanMatchesMonotoneChain(lines), "chan, collinear runs");
+	}
+
+	// Enough points for several chunks, every chunk holds copies of the hull points
+	std::vector<Vector2f> grid;
+	for (int i = 0; i < (1 << 18); i++)
+	{
+		grid.emplace_back(float(gen() % 5), float(gen() % 5));
+	}
+	ok &= check(reportsSmallestIds(grid, 4), "5x5 grid copy ids, 4 threads");
+
+	std::printf(ok ? "passed\n" : "failed\n");
+	return ok ? 0 : 1;
+}
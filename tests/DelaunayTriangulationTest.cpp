@@ -0,0 +1,705 @@
+// Delaunay triangulation of inputs with repeated points, for every insertion order and point location,
+// constrained Delaunay triangulation of non-crossing segments, and its Ruppert refinement
+// Returns non-zero on the first mismatch
+
+#include "DelaunayTriangulation.h"
+#include "ParallelDelaunayTriangulation.h"
+#include "Predicates.h"
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+
+namespace
+{
+
+bool check(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", what);
+	}
+	return condition;
+}
+
+bool lexLess(const Vector2f& a, const Vector2f& b)
+{
+	return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+// Twice the area of the convex hull, by monotone chain
+double hullArea(std::vector<Vector2f> points)
+{
+	std::sort(points.begin(), points.end(), lexLess);
+	std::vector<Vector2f> hull(2 * points.size());
+	size_t k = 0;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		while (k >= 2 && Predicates::orient2d(hull[k - 2], hull[k - 1], points[i]) <= 0)
+		{
+			k--;
+		}
+		hull[k++] = points[i];
+	}
+	for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;)
+	{
+		while (k >= lower && Predicates::orient2d(hull[k - 2], hull[k - 1], points[i]) <= 0)
+		{
+			k--;
+		}
+		hull[k++] = points[i];
+	}
+
+	double area = 0;
+	for (size_t i = 2; i + 1 < k; i++)
+	{
+		area += Predicates::orient2d(hull[0], hull[i - 1], hull[i]);
+	}
+	return area;
+}
+
+// Counter-clockwise triangles with empty circumcircles covering the hull and every input position
+bool isDelaunay(const std::vector<Vector2f>& points, const std::vector<uint32_t>& indices)
+{
+	std::vector<Vector2f> vertices;
+	for (uint32_t id : indices)
+	{
+		vertices.push_back(points[id]);
+	}
+	std::sort(vertices.begin(), vertices.end(), lexLess);
+	for (const Vector2f& p : points)
+	{
+		if (!std::binary_search(vertices.begin(), vertices.end(), p, lexLess))
+		{
+			return false;
+		}
+	}
+
+	double area = 0;
+	for (size_t t = 0; t < indices.size(); t += 3)
+	{
+		const Vector2f a = points[indices[t]];
+		const Vector2f b = points[indices[t + 1]];
+		const Vector2f c = points[indices[t + 2]];
+		const double triArea = Predicates::orient2d(a, b, c);
+		if (triArea <= 0)
+		{
+			return false;
+		}
+		area += triArea;
+		for (uint32_t id : indices)
+		{
+			if (Predicates::inCircle(a, b, c, points[id]) > 0)
+			{
+				return false;
+			}
+		}
+	}
+	const double expected = hullArea(points);
+	return std::abs(area - expected) <= 1e-9 * expected;
+}
+
+// Each repeated point is left out once and mapped to a vertex at its position
+template <typename Triangulation>
+bool skipsDuplicates(const std::vector<Vector2f>& points, const std::vector<uint32_t>& indices,
+					 const Triangulation& dt)
+{
+	std::vector<bool> used(points.size(), false);
+	for (uint32_t id : indices)
+	{
+		used[id] = true;
+	}
+	for (const auto& duplicate : dt.duplicatePoints())
+	{
+		const size_t skipped = duplicate.first;
+		const size_t vertex = duplicate.second;
+		if (used[skipped] || !used[vertex] || points[skipped] != points[vertex])
+		{
+			return false;
+		}
+		used[skipped] = true;
+	}
+	return std::find(used.begin(), used.end(), false) == used.end();
+}
+
+template <typename Triangulation>
+bool allOrdersDelaunay(const std::vector<Vector2f>& points)
+{
+	using Order = typename Triangulation::InsertionOrder;
+	using Location = typename Triangulation::PointLocation;
+	for (Order order : { Order::Input, Order::BiasedRandomized })
+	{
+		for (Location location : { Location::Bucketing, Location::Walk })
+		{
+			std::vector<Vector2f> input = points;
+			Triangulation dt(input, order, location);
+			std::vector<uint32_t> indices;
+			dt.extractTriangleIndices(indices);
+			if (!isDelaunay(points, indices) || !skipsDuplicates(points, indices, dt))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool allEnginesDelaunay(const std::vector<Vector2f>& points)
+{
+	if (!allOrdersDelaunay<DelaunayTriangulation>(points) || !allOrdersDelaunay<CompactDelaunayTriangulation>(points))
+	{
+		return false;
+	}
+
+	std::vector<Vector2f> input = points;
+	ParallelDelaunayTriangulation pdt(input, 1);
+	std::vector<uint32_t> indices;
+	pdt.extractTriangleIndices(indices);
+	return isDelaunay(points, indices);
+}
+
+using Segment = std::pair<uint32_t, uint32_t>;
+
+Segment undirected(uint32_t a, uint32_t b)
+{
+	return a < b ? Segment(a, b) : Segment(b, a);
+}
+
+bool crosses(const Vector2f& a, const Vector2f& b, const Vector2f& c, const Vector2f& d)
+{
+	auto sign = [](double v) { return (v > 0) - (v < 0); };
+	return sign(Predicates::orient2d(a, b, c)) * sign(Predicates::orient2d(a, b, d)) < 0
+		&& sign(Predicates::orient2d(c, d, a)) * sign(Predicates::orient2d(c, d, b)) < 0;
+}
+
+// Counter-clockwise triangles of the given total area, each edge once per direction, constrained
+// pairs are edges, every edge with a triangle on both sides is locally Delaunay unless it is constrained
+bool isConstrainedDelaunay(const std::vector<Vector2f>& points, const std::vector<uint32_t>& indices,
+						   const std::set<Segment>& constrained, double expectedArea, double tolerance = 1e-9)
+{
+	// Vertex opposite each directed edge
+	std::map<Segment, uint32_t> opposite;
+	double area = 0;
+	for (size_t t = 0; t < indices.size(); t += 3)
+	{
+		const double triArea = Predicates::orient2d(points[indices[t]], points[indices[t + 1]], points[indices[t + 2]]);
+		if (triArea <= 0)
+		{
+			return false;
+		}
+		area += triArea;
+		for (size_t i = 0; i < 3; i++)
+		{
+			if (!opposite.emplace(Segment(indices[t + i], indices[t + (i + 1) % 3]), indices[t + (i + 2) % 3]).second)
+			{
+				return false;
+			}
+		}
+	}
+
+	for (const Segment& segment : constrained)
+	{
+		if (!opposite.count(segment) && !opposite.count({ segment.second, segment.first }))
+		{
+			return false;
+		}
+	}
+	for (const auto& edge : opposite)
+	{
+		const auto twin = opposite.find({ edge.first.second, edge.first.first });
+		if (twin == opposite.end() || constrained.count(undirected(edge.first.first, edge.first.second)))
+		{
+			continue;
+		}
+		if (Predicates::inCircle(points[edge.first.first], points[edge.first.second], points[edge.second],
+								 points[twin->second]) > 0)
+		{
+			return false;
+		}
+	}
+	return std::abs(area - expectedArea) <= tolerance * expectedArea;
+}
+
+// Every segment is a chain of constrained edges through the points on it
+bool coversSegments(const std::vector<Vector2f>& points, const std::vector<Segment>& segments,
+					const std::set<Segment>& constrained)
+{
+	for (const Segment& segment : segments)
+	{
+		const Vector2f a = points[segment.first];
+		const Vector2f b = points[segment.second];
+		std::vector<std::pair<float, uint32_t>> onSegment;
+		for (uint32_t i = 0; i < points.size(); i++)
+		{
+			const float t = dot(points[i] - a, b - a);
+			if (Predicates::orient2d(a, b, points[i]) == 0 && t >= 0 && t <= dot(b - a, b - a))
+			{
+				onSegment.emplace_back(t, i);
+			}
+		}
+		std::sort(onSegment.begin(), onSegment.end());
+		for (size_t i = 1; i < onSegment.size(); i++)
+		{
+			if (!constrained.count(undirected(onSegment[i - 1].second, onSegment[i].second)))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Segments between random pairs of points, each kept if it crosses none of the earlier ones
+std::vector<Segment> nonCrossingSegments(std::mt19937& gen, const std::vector<Vector2f>& points, size_t tries)
+{
+	std::vector<Segment> segments;
+	for (size_t i = 0; i < tries; i++)
+	{
+		const uint32_t a = gen() % points.size();
+		const uint32_t b = gen() % points.size();
+		bool free = a != b;
+		for (size_t j = 0; free && j < segments.size(); j++)
+		{
+			free = !crosses(points[a], points[b], points[segments[j].first], points[segments[j].second]);
+		}
+		if (free)
+		{
+			segments.emplace_back(a, b);
+		}
+	}
+	return segments;
+}
+
+std::set<Segment> constraintSet(const std::vector<uint32_t>& constraintIndices)
+{
+	std::set<Segment> constrained;
+	for (size_t i = 0; i < constraintIndices.size(); i += 2)
+	{
+		constrained.insert(undirected(constraintIndices[i], constraintIndices[i + 1]));
+	}
+	return constrained;
+}
+
+template <typename Triangulation>
+bool constrainedDelaunay(const std::vector<Vector2f>& points, const std::vector<Segment>& segments)
+{
+	using Order = typename Triangulation::InsertionOrder;
+	using Location = typename Triangulation::PointLocation;
+	// Constraints change which edges there are, not how many triangles
+	std::vector<Vector2f> unconstrainedInput = points;
+	Triangulation unconstrained(unconstrainedInput);
+	std::vector<uint32_t> unconstrainedIndices;
+	unconstrained.extractTriangleIndices(unconstrainedIndices);
+	const size_t triangleCount = unconstrainedIndices.size();
+
+	for (Order order : { Order::Input, Order::BiasedRandomized })
+	{
+		for (Location location : { Location::Bucketing, Location::Walk })
+		{
+			std::vector<Vector2f> input = points;
+			Triangulation dt(input, order, location);
+			for (const Segment& segment : segments)
+			{
+				if (!dt.insertConstraint(segment.first, segment.second))
+				{
+					return false;
+				}
+			}
+			std::vector<uint32_t> indices, constraintIndices;
+			dt.extractTriangleIndices(indices);
+			dt.extractConstraintIndices(constraintIndices);
+			const std::set<Segment> constrained = constraintSet(constraintIndices);
+			if (indices.size() != triangleCount
+				|| !isConstrainedDelaunay(points, indices, constrained, hullArea(points))
+				|| !coversSegments(points, segments, constrained))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Smallest angle of a triangle in degrees
+double minAngle(const Vector2f& a, const Vector2f& b, const Vector2f& c)
+{
+	auto angle = [](const Vector2f& p, const Vector2f& q, const Vector2f& r)
+	{
+		const double ux = double(q.x) - p.x, uy = double(q.y) - p.y;
+		const double vx = double(r.x) - p.x, vy = double(r.y) - p.y;
+		return std::atan2(std::abs(ux * vy - uy * vx), ux * vx + uy * vy) * 57.29577951308232;
+	};
+	return std::min(angle(a, b, c), std::min(angle(b, c, a), angle(c, a, b)));
+}
+
+// Constrained edges from one end of a segment reach the other through points within
+// rounding distance of it, refine splits segments at rounded points
+bool keepsSubsegments(const std::vector<Vector2f>& points, const std::vector<Segment>& segments,
+					  const std::set<Segment>& constrained)
+{
+	std::map<uint32_t, std::vector<uint32_t>> neighbours;
+	for (const Segment& edge : constrained)
+	{
+		neighbours[edge.first].push_back(edge.second);
+		neighbours[edge.second].push_back(edge.first);
+	}
+	for (const Segment& segment : segments)
+	{
+		const Vector2f a = points[segment.first];
+		const Vector2f b = points[segment.second];
+		const double length = std::sqrt(double(dot(b - a, b - a)));
+		std::set<uint32_t> visited{ segment.first };
+		std::vector<uint32_t> stack{ segment.first };
+		while (!stack.empty() && !visited.count(segment.second))
+		{
+			const uint32_t u = stack.back();
+			stack.pop_back();
+			for (uint32_t v : neighbours[u])
+			{
+				const double t = dot(points[v] - a, b - a) / (length * length);
+				const double distance = std::abs(Predicates::orient2d(a, b, points[v])) / length;
+				if (t >= -1e-6 && t <= 1 + 1e-6 && distance <= 1e-5 * length && visited.insert(v).second)
+				{
+					stack.push_back(v);
+				}
+			}
+		}
+		if (!visited.count(segment.second))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Refinement adds at most maxPointCount points, keeps the domain and every segment as a chain
+// of constrained edges, and stays constrained Delaunay
+// Once it finishes below the cap, every triangle meets the area bound, and the angle bound too
+// when checkAngles is set, for inputs whose segments meet at 60 degrees or more
+template <typename Triangulation>
+bool refines(const std::vector<Vector2f>& points, const std::vector<Segment>& segments,
+			 float angleBound, float areaBound, size_t maxPointCount, bool checkAngles)
+{
+	std::vector<Vector2f> input = points;
+	Triangulation dt(input);
+	for (const Segment& segment : segments)
+	{
+		if (!dt.insertConstraint(segment.first, segment.second))
+		{
+			return false;
+		}
+	}
+	const size_t added = dt.refine(angleBound, areaBound, maxPointCount);
+	if (added > maxPointCount || dt.points().size() != points.size() + added)
+	{
+		return false;
+	}
+
+	std::vector<Vector2f> refined;
+	for (size_t i = 0; i < dt.points().size(); i++)
+	{
+		refined.push_back(dt.points()[i]);
+	}
+	std::vector<uint32_t> indices, constraintIndices;
+	dt.extractTriangleIndices(indices);
+	dt.extractConstraintIndices(constraintIndices);
+	const std::set<Segment> constrained = constraintSet(constraintIndices);
+	// Split points on the hull are rounded, which moves its area by float resolution
+	if (!isConstrainedDelaunay(refined, indices, constrained, hullArea(points), 1e-6)
+		|| !keepsSubsegments(refined, segments, constrained))
+	{
+		return false;
+	}
+	if (added == maxPointCount)
+	{
+		return true;
+	}
+	for (size_t t = 0; t < indices.size(); t += 3)
+	{
+		const Vector2f a = refined[indices[t]];
+		const Vector2f b = refined[indices[t + 1]];
+		const Vector2f c = refined[indices[t + 2]];
+		if (Predicates::orient2d(a, b, c) / 2 > areaBound * (1 + 1e-6)
+			|| (checkAngles && minAngle(a, b, c) < angleBound - 1e-3))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Moves and removals on a grid whose sides and a diagonal are constrained, points leave
+// the hull and come back next to the constrained sides, some land exactly on constrained edges
+// After every update the constraints are the same, removed points are out of the mesh,
+// and the mesh is constrained Delaunay over the hull of the points left
+template <typename Triangulation>
+bool updatesKeepConstraints(std::mt19937& gen, int side, size_t updateCount)
+{
+	std::vector<Vector2f> points;
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			points.emplace_back(float(x), float(y));
+		}
+	}
+	const uint32_t last = static_cast<uint32_t>(side - 1);
+	const uint32_t corners[] = { 0, last, last * side + last, last * side };
+	std::vector<Vector2f> input = points;
+	Triangulation dt(input);
+	for (int i = 0; i < 4; i++)
+	{
+		dt.insertConstraint(corners[i], corners[(i + 1) % 4]);
+	}
+	dt.insertConstraint(side + 1, 2 * side + 3);
+	std::vector<uint32_t> constraintIndices;
+	dt.extractConstraintIndices(constraintIndices);
+	const std::set<Segment> expected = constraintSet(constraintIndices);
+
+	std::vector<bool> removed(points.size(), false);
+	// Halves of the grid spacing, every midpoint of an edge is exact
+	std::uniform_int_distribution<int> coord(-6, 2 * side + 4);
+	for (size_t update = 0; update < updateCount; update++)
+	{
+		const size_t pid = gen() % points.size();
+		const Vector2f old = dt.points()[pid];
+		const int kind = gen() % 4;
+		if (kind == 0)
+		{
+			removed[pid] = removed[pid] || dt.removePoint(pid);
+		}
+		else
+		{
+			Vector2f p(0.5f * float(coord(gen)), 0.5f * float(coord(gen)));
+			if (kind == 2)
+			{
+				// The middle of a constrained edge
+				const Segment edge = *std::next(expected.begin(), gen() % expected.size());
+				p = (dt.points()[edge.first] + dt.points()[edge.second]) * 0.5f;
+			}
+			else if (kind == 3)
+			{
+				// A step small enough to stay in the star mostly
+				p = old + Vector2f(0.25f * float(int(gen() % 3) - 1), 0.25f * float(int(gen() % 3) - 1));
+			}
+			const bool moved = dt.movePoint(pid, p);
+			if ((kind == 2 && moved) || dt.points()[pid] != (moved ? p : old))
+			{
+				return false;
+			}
+			removed[pid] = removed[pid] && !moved;
+		}
+
+		std::vector<Vector2f> current, left;
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			current.push_back(dt.points()[i]);
+			if (!removed[i])
+			{
+				left.push_back(current.back());
+			}
+		}
+		std::vector<uint32_t> indices;
+		dt.extractTriangleIndices(indices);
+		constraintIndices.clear();
+		dt.extractConstraintIndices(constraintIndices);
+		std::vector<bool> inMesh(points.size(), false);
+		for (uint32_t id : indices)
+		{
+			inMesh[id] = true;
+		}
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			if (inMesh[i] == removed[i])
+			{
+				return false;
+			}
+		}
+		if (constraintSet(constraintIndices) != expected
+			|| !isConstrainedDelaunay(current, indices, expected, hullArea(left)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main()
+{
+	bool ok = true;
+
+	// 6n half-edges within the signed range of the offsets
+	ok &= check(CompactDelaunayTriangulation::maxMeshPointCount() == 357913941, "compact mesh point limit");
+	ok &= check(DelaunayTriangulation::maxMeshPointCount() > (size_t(1) << 32), "mesh point limit");
+
+	ok &= check(allEnginesDelaunay({ { 0, 0 }, { 1, 3 }, { 1, 3 }, { 3, 1 } }), "repeated corner");
+	ok &= check(allEnginesDelaunay({ { 0, 0 }, { 0, 0 }, { 1, 3 }, { 3, 1 } }), "repeated leftmost point");
+	ok &= check(allEnginesDelaunay({ { 0, 0 }, { 1, 3 }, { 3, 1 }, { 0, 0 }, { 1, 3 }, { 3, 1 }, { 1, 1 }, { 1, 1 } }),
+				"every point repeated");
+	// The center splits the diagonal, its copy is collinear with both halves
+	ok &= check(allEnginesDelaunay({ { 0, 0 }, { 2, 0 }, { 2, 2 }, { 0, 2 }, { 1, 1 }, { 1, 1 }, { 2, 0 } }),
+				"repeated point on an edge");
+
+	std::mt19937 gen(1);
+	for (int round = 0; round < 20; round++)
+	{
+		// Points on the unit circle at a few angles, as the circular benchmark produces at large counts
+		std::vector<Vector2f> circle;
+		for (int i = 0; i < 200; i++)
+		{
+			const float a = float(gen() % 64) * 6.28318531f / 64;
+			circle.emplace_back(std::cos(a), std::sin(a));
+		}
+		ok &= check(allEnginesDelaunay(circle), "circle copies");
+
+		// 100 points of a 5x5 grid, copies on edges and corners of every face
+		std::vector<Vector2f> grid;
+		for (int i = 0; i < 100; i++)
+		{
+			grid.emplace_back(float(gen() % 5), float(gen() % 5));
+		}
+		ok &= check(allEnginesDelaunay(grid), "5x5 grid copies");
+
+		// Random points with copies of some of them spread through
+		std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+		std::vector<Vector2f> points;
+		for (int i = 0; i < 200; i++)
+		{
+			points.emplace_back(coord(gen), coord(gen));
+		}
+		for (int i = 0; i < 50; i++)
+		{
+			const Vector2f copy = points[gen() % points.size()];
+			points.insert(points.begin() + gen() % points.size(), copy);
+		}
+		ok &= check(allEnginesDelaunay(points), "random copies");
+	}
+
+	// Constraints between random points, on integer grids through other points and along
+	// cocircular ones, for both meshes
+	for (int round = 0; round < 20; round++)
+	{
+		std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+		std::set<std::pair<float, float>> seen;
+		std::vector<Vector2f> points, grid;
+		while (points.size() < 100)
+		{
+			const Vector2f p(coord(gen), coord(gen));
+			if (seen.insert({ p.x, p.y }).second)
+			{
+				points.push_back(p);
+			}
+		}
+		ok &= check(constrainedDelaunay<DelaunayTriangulation>(points, nonCrossingSegments(gen, points, 60)),
+					"random constraints");
+		ok &= check(constrainedDelaunay<CompactDelaunayTriangulation>(points, nonCrossingSegments(gen, points, 60)),
+					"random constraints, compact mesh");
+
+		for (int y = 0; y < 8; y++)
+		{
+			for (int x = 0; x < 8; x++)
+			{
+				grid.emplace_back(float(x), float(y));
+			}
+		}
+		std::shuffle(grid.begin(), grid.end(), gen);
+		ok &= check(constrainedDelaunay<DelaunayTriangulation>(grid, nonCrossingSegments(gen, grid, 40)),
+					"grid constraints");
+	}
+	// Chords of a circle, every quad of the triangulation is cocircular
+	std::vector<Vector2f> circle;
+	for (int i = 0; i < 32; i++)
+	{
+		const float a = float(i) * 6.28318531f / 32;
+		circle.emplace_back(std::cos(a), std::sin(a));
+	}
+	ok &= check(constrainedDelaunay<DelaunayTriangulation>(circle, { { 0, 16 }, { 3, 12 }, { 20, 28 }, { 5, 6 } }),
+				"circle chords");
+
+	// A segment crossing a constrained edge is refused and leaves it in place
+	{
+		std::vector<Vector2f> points{ { 0, 0 }, { 1, 1 }, { 0, 1 }, { 1, 0 }, { 0.5f, 2 }, { 0.5f, -1 } };
+		const std::vector<Vector2f> input = points;
+		DelaunayTriangulation dt(points);
+		ok &= check(dt.insertConstraint(0, 1), "first diagonal");
+		ok &= check(!dt.insertConstraint(2, 3), "crossing diagonal");
+		std::vector<uint32_t> indices, constraintIndices;
+		dt.extractTriangleIndices(indices);
+		dt.extractConstraintIndices(constraintIndices);
+		const std::set<Segment> constrained = constraintSet(constraintIndices);
+		ok &= check(constrained == std::set<Segment>{ { 0, 1 } } && isConstrainedDelaunay(input, indices, constrained, hullArea(input)),
+					"crossing diagonal refused");
+	}
+
+	// A square inside a square and a hexagon inside that, split by points on their sides,
+	// with grid points around, so segments only meet at 90 and 120 degrees
+	{
+		std::vector<Vector2f> points{ { 0, 0 }, { 16, 0 }, { 16, 16 }, { 0, 16 },
+									  { 4, 4 }, { 12, 4 }, { 12, 12 }, { 4, 12 }, { 8, 4 } };
+		std::vector<Segment> segments{ { 4, 8 }, { 8, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 } };
+		const uint32_t hexagon = static_cast<uint32_t>(points.size());
+		for (int i = 0; i < 6; i++)
+		{
+			const float a = float(i) * 6.28318531f / 6;
+			points.emplace_back(8 + 2 * std::cos(a), 8 + 2 * std::sin(a));
+			segments.emplace_back(hexagon + i, hexagon + (i + 1) % 6);
+		}
+		for (int y = 1; y < 16; y += 3)
+		{
+			for (int x = 1; x < 16; x += 5)
+			{
+				points.emplace_back(float(x), float(y));
+			}
+		}
+		for (float angleBound : { 20.0f, 25.0f })
+		{
+			ok &= check(refines<DelaunayTriangulation>(points, segments, angleBound, 1.0f, 100000, true),
+						"refined squares and hexagon");
+			ok &= check(refines<CompactDelaunayTriangulation>(points, segments, angleBound, 4.0f, 100000, true),
+						"refined squares and hexagon, compact mesh");
+		}
+		for (size_t cap : { 0, 1, 10, 100 })
+		{
+			ok &= check(refines<DelaunayTriangulation>(points, segments, 20.0f, 0.01f, cap, true), "point cap");
+		}
+	}
+
+	// Random points and segments, small input angles leave the angle bound unchecked
+	for (int round = 0; round < 10; round++)
+	{
+		std::uniform_real_distribution<float> coord(0.0f, 1.0f);
+		std::set<std::pair<float, float>> seen;
+		std::vector<Vector2f> points;
+		while (points.size() < 100)
+		{
+			const Vector2f p(coord(gen), coord(gen));
+			if (seen.insert({ p.x, p.y }).second)
+			{
+				points.push_back(p);
+			}
+		}
+		const std::vector<Segment> segments = nonCrossingSegments(gen, points, 20);
+		ok &= check(refines<DelaunayTriangulation>(points, segments, 20.0f, 0.001f, 20000, false),
+					"refined random constraints");
+		// Several segments may be split for one triangle, each of them counts towards the cap
+		for (size_t cap = 0; cap < 200; cap += 7)
+		{
+			ok &= check(refines<DelaunayTriangulation>(points, segments, 20.0f, 0.001f, cap, false), "point cap, random");
+		}
+	}
+	// Cocircular points without segments, only the hull bounds the domain
+	ok &= check(refines<DelaunayTriangulation>(circle, {}, 20.0f, 0.01f, 20000, true), "refined circle");
+
+	for (int round = 0; round < 10; round++)
+	{
+		ok &= check(updatesKeepConstraints<DelaunayTriangulation>(gen, 4 + round, 300), "updates next to constraints");
+		ok &= check(updatesKeepConstraints<CompactDelaunayTriangulation>(gen, 4 + round, 300),
+					"updates next to constraints, compact mesh");
+	}
+
+	std::printf(ok ? "passed\n" : "failed\n");
+	return ok ? 0 : 1;
+}
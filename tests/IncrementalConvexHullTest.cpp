@@ -0,0 +1,117 @@
+// IncrementalConvexHull against ConvexHull in monotone chain mode after every insertion,
+// on inputs with repeated points, collinear runs and signed zeros
+// Returns non-zero on the first mismatch
+
+#include "IncrementalConvexHull.h"
+#include "ConvexHull.h"
+
+#include <cstdio>
+#include <random>
+
+namespace
+{
+
+bool check(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", what);
+	}
+	return condition;
+}
+
+std::vector<uint32_t> monotoneChain(std::vector<Vector2f> points)
+{
+	ConvexHull hull(points, ConvexHull::Algorithm::MonotoneChain);
+	hull.process();
+	std::vector<uint32_t> indices;
+	hull.extractLineSegmentIndices(indices);
+	return indices;
+}
+
+// Same ids as the batch hull of every prefix, insert reports whether the point is a vertex
+bool matchesMonotoneChain(const std::vector<Vector2f>& points)
+{
+	IncrementalConvexHull hull;
+	std::vector<Vector2f> prefix;
+	for (const Vector2f& p : points)
+	{
+		const bool isVertex = hull.insert(p);
+		prefix.push_back(p);
+
+		std::vector<uint32_t> indices;
+		hull.extractLineSegmentIndices(indices);
+		const std::vector<uint32_t> expected = monotoneChain(prefix);
+		const uint32_t id = static_cast<uint32_t>(prefix.size() - 1);
+		// A single distinct point has no segments, its first copy is the only vertex
+		const bool expectedVertex = expected.empty()
+			? id == 0
+			: std::find(expected.begin(), expected.end(), id) != expected.end();
+		if (indices != expected || isVertex != expectedVertex || hull.pointCount() != prefix.size()
+			|| hull.vertexCount() != std::max<size_t>(expected.size(), 1))
+		{
+			return false;
+		}
+	}
+
+	// Inserting all points at once gives the same hull
+	IncrementalConvexHull batch;
+	batch.insert(points);
+	std::vector<uint32_t> indices;
+	batch.extractLineSegmentIndices(indices);
+	return indices == monotoneChain(points);
+}
+
+}
+
+int main()
+{
+	bool ok = true;
+
+	ok &= check(matchesMonotoneChain({ { 0, 0 } }), "single point");
+	ok &= check(matchesMonotoneChain({ { 0, 0 }, { 0, 0 }, { 0, 0 } }), "one point repeated");
+	ok &= check(matchesMonotoneChain({ { 0, 0 }, { 1, 1 }, { 2, 2 }, { 3, 3 }, { 1, 1 } }), "collinear run");
+	ok &= check(matchesMonotoneChain({ { 3, 3 }, { 2, 2 }, { 1, 1 }, { 0, 0 }, { 2, 2 } }), "collinear run, reversed");
+	ok &= check(matchesMonotoneChain({ { 0, 0 }, { 0, 2 }, { 0, 1 }, { 0, 3 } }), "vertical run");
+	// Points on the hull edges do not become vertices
+	ok &= check(matchesMonotoneChain({ { 0, 0 }, { 4, 0 }, { 4, 4 }, { 0, 4 }, { 2, 0 }, { 4, 2 }, { 2, 4 }, { 0, 2 } }),
+				"points on edges");
+	ok &= check(matchesMonotoneChain({ { 0.0f, 1 }, { 1, 0.0f }, { -0.0f, 1 }, { 1, -0.0f }, { -1, -0.0f }, { -0.0f, -0.0f } }),
+				"signed zeros");
+
+	std::mt19937 gen(1);
+	for (int round = 0; round < 20; round++)
+	{
+		// 100 points of a 5x5 grid, every hull point repeats
+		std::vector<Vector2f> grid;
+		for (int i = 0; i < 100; i++)
+		{
+			grid.emplace_back(float(gen() % 5), float(gen() % 5));
+		}
+		ok &= check(matchesMonotoneChain(grid), "5x5 grid copies");
+
+		// Random points with copies spread through, then runs along the x axis
+		std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+		std::vector<Vector2f> points;
+		for (int i = 0; i < 100; i++)
+		{
+			points.emplace_back(coord(gen), coord(gen));
+		}
+		for (int i = 0; i < 20; i++)
+		{
+			const Vector2f copy = points[gen() % points.size()];
+			points.insert(points.begin() + gen() % points.size(), copy);
+		}
+		ok &= check(matchesMonotoneChain(points), "random copies");
+
+		std::vector<Vector2f> line;
+		for (int i = 0; i < 50; i++)
+		{
+			line.emplace_back(float(gen() % 20) - 10.0f, i % 3 ? 0.0f : -0.0f);
+		}
+		ok &= check(matchesMonotoneChain(line), "collinear copies");
+	}
+
+	std::printf(ok ? "passed\n" : "failed\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,378 @@
+// Polygon triangulation checked against the polygon itself: n + 2h - 2 counter-clockwise
+// triangles whose areas sum to the polygon area, every side used once along the boundary
+// and every diagonal once in each direction
+// Batches must match one triangulation per polygon
+// Returns non-zero on the first mismatch
+
+#include "PolygonTriangulation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+
+namespace
+{
+
+using Algorithm = PolygonTriangulation::Algorithm;
+
+bool check(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", what);
+	}
+	return condition;
+}
+
+// Twice the signed area of the ring of points [first, last)
+double ringArea(const std::vector<Vector2f>& points, size_t first, size_t last)
+{
+	double area = 0;
+	for (size_t i = first; i < last; i++)
+	{
+		const Vector2f a = points[i];
+		const Vector2f b = points[i + 1 < last ? i + 1 : first];
+		area += double(a.x) * b.y - double(b.x) * a.y;
+	}
+	return area;
+}
+
+// Triangles of the polygon whose rings start at ringOffsets, ids into points
+bool isTriangulation(const std::vector<Vector2f>& points, const std::vector<size_t>& ringOffsets,
+					 const std::vector<uint32_t>& indices)
+{
+	const size_t holeCount = ringOffsets.size() - 1;
+	if (indices.size() != 3 * (points.size() + 2 * holeCount - 2))
+	{
+		return false;
+	}
+
+	// Directed edges of the triangles
+	std::map<std::pair<uint32_t, uint32_t>, int> edges;
+	double area = 0;
+	for (size_t t = 0; t < indices.size(); t += 3)
+	{
+		const double triArea = Predicates::orient2d(points[indices[t]], points[indices[t + 1]], points[indices[t + 2]]);
+		if (triArea < 0)
+		{
+			return false;
+		}
+		area += triArea;
+		for (size_t i = 0; i < 3; i++)
+		{
+			edges[{ indices[t + i], indices[t + (i + 1) % 3] }]++;
+		}
+	}
+
+	// Sides with the interior on their left, outer ring counter-clockwise and holes clockwise
+	double expectedArea = 0;
+	std::map<std::pair<uint32_t, uint32_t>, int> sides;
+	for (size_t ring = 0; ring <= holeCount; ring++)
+	{
+		const size_t first = ringOffsets[ring];
+		const size_t last = ring < holeCount ? ringOffsets[ring + 1] : points.size();
+		const double signedArea = ringArea(points, first, last);
+		const bool forward = (signedArea > 0) == (ring == 0);
+		expectedArea += ring == 0 ? std::abs(signedArea) : -std::abs(signedArea);
+		for (size_t i = first; i < last; i++)
+		{
+			const uint32_t a = static_cast<uint32_t>(i);
+			const uint32_t b = static_cast<uint32_t>(i + 1 < last ? i + 1 : first);
+			sides[forward ? std::make_pair(a, b) : std::make_pair(b, a)]++;
+		}
+	}
+
+	for (const auto& edge : edges)
+	{
+		const auto side = sides.find(edge.first);
+		const auto twin = edges.find({ edge.first.second, edge.first.first });
+		const bool isSide = side != sides.end();
+		if (edge.second != 1 || (isSide ? twin != edges.end() : twin == edges.end()))
+		{
+			return false;
+		}
+	}
+	for (const auto& side : sides)
+	{
+		if (edges.find(side.first) == edges.end())
+		{
+			return false;
+		}
+	}
+	return std::abs(area - expectedArea) <= 1e-9 * expectedArea;
+}
+
+bool triangulates(const std::vector<Vector2f>& points, Algorithm algorithm)
+{
+	// The input vector is taken over, the check needs its own copy
+	std::vector<Vector2f> input = points;
+	PolygonTriangulation polygon(input, algorithm);
+	std::vector<uint32_t> indices;
+	polygon.extractTriangleIndices(indices);
+	return isTriangulation(points, { 0 }, indices);
+}
+
+bool triangulatesWithHoles(const std::vector<Vector2f>& points, const std::vector<size_t>& ringOffsets,
+						   Algorithm algorithm)
+{
+	std::vector<Vector2f> input = points;
+	PolygonTriangulation polygon(input, ringOffsets, algorithm);
+	std::vector<uint32_t> indices;
+	polygon.extractTriangleIndices(indices);
+	return isTriangulation(points, ringOffsets, indices);
+}
+
+// Polygons given as points and ring offsets each, stored back to back for the batch
+struct Polygon
+{
+	std::vector<Vector2f> points;
+	std::vector<size_t> ringOffsets;
+};
+
+// Batch slices hold 3 (n + 2h - 2) ids, the same as one triangulation per polygon
+// shifted by the polygon's first point, for any thread count
+bool batchMatchesSingle(const std::vector<Polygon>& polygons, Algorithm algorithm)
+{
+	std::vector<Vector2f> points;
+	std::vector<size_t> ringOffsets, polygonOffsets;
+	for (const Polygon& polygon : polygons)
+	{
+		polygonOffsets.push_back(ringOffsets.size());
+		for (size_t offset : polygon.ringOffsets)
+		{
+			ringOffsets.push_back(points.size() + offset);
+		}
+		points.insert(points.end(), polygon.points.begin(), polygon.points.end());
+	}
+
+	for (size_t threadCount : { 1, 4 })
+	{
+		std::vector<uint32_t> indices;
+		std::vector<size_t> indexOffsets;
+		PolygonTriangulation::triangulateBatch(points, ringOffsets, polygonOffsets, indices, indexOffsets,
+											   algorithm, threadCount);
+		if (indexOffsets.size() != polygons.size() + 1 || indexOffsets.back() != indices.size())
+		{
+			return false;
+		}
+
+		uint32_t base = 0;
+		for (size_t i = 0; i < polygons.size(); i++)
+		{
+			const Polygon& polygon = polygons[i];
+			std::vector<Vector2f> input = polygon.points;
+			PolygonTriangulation single(input, polygon.ringOffsets, algorithm);
+			std::vector<uint32_t> expected;
+			single.extractTriangleIndices(expected);
+			const size_t holeCount = polygon.ringOffsets.size() - 1;
+			if (indexOffsets[i + 1] - indexOffsets[i] != 3 * (polygon.points.size() + 2 * holeCount - 2)
+				|| expected.size() != indexOffsets[i + 1] - indexOffsets[i]
+				|| !std::equal(expected.begin(), expected.end(), indices.begin() + indexOffsets[i],
+							   [base](uint32_t local, uint32_t global) { return local + base == global; }))
+			{
+				return false;
+			}
+			base += static_cast<uint32_t>(polygon.points.size());
+		}
+	}
+	return true;
+}
+
+// Each polygon in both orientations
+bool triangulatesBothWays(std::vector<Vector2f> points, Algorithm algorithm)
+{
+	if (!triangulates(points, algorithm))
+	{
+		return false;
+	}
+	std::reverse(points.begin(), points.end());
+	return triangulates(points, algorithm);
+}
+
+// Auto ear clips small polygons, which leaves no monotone pieces, and sweeps the others
+bool autoPicksBySize(const std::vector<Vector2f>& points)
+{
+	std::vector<Vector2f> input = points;
+	PolygonTriangulation polygon(input, Algorithm::Auto);
+	const bool swept = !polygon.monotonePolygons().empty();
+	return swept == (points.size() >= PolygonTriangulation::cEarClippingMaxSize);
+}
+
+// Random radius at each of n distinct angles around c, counter-clockwise
+std::vector<Vector2f> star(std::mt19937& gen, size_t n, Vector2f c = Vector2f(0, 0), float scale = 1.0f)
+{
+	std::uniform_real_distribution<float> radius(0.2f, 1.0f);
+	std::vector<Vector2f> points;
+	for (size_t i = 0; i < n; i++)
+	{
+		const float a = 6.28318531f * float(i) / float(n);
+		const float r = scale * radius(gen);
+		points.emplace_back(c.x + r * std::cos(a), c.y + r * std::sin(a));
+	}
+	return points;
+}
+
+// Teeth of random heights hanging off both sides of a bar, integer coordinates,
+// so tooth tips and the bar share y values and many sides are horizontal
+std::vector<Vector2f> comb(std::mt19937& gen, size_t teeth)
+{
+	std::vector<Vector2f> points;
+	for (size_t i = 0; i < teeth; i++)
+	{
+		const float x = float(2 * i);
+		const float depth = float(1 + gen() % 4);
+		points.emplace_back(x, -depth);
+		points.emplace_back(x + 1, -depth);
+		points.emplace_back(x + 1, 0.0f);
+	}
+	for (size_t i = teeth; i-- > 0;)
+	{
+		const float x = float(2 * i);
+		const float height = float(1 + gen() % 4);
+		points.emplace_back(x + 1, 1.0f);
+		points.emplace_back(x + 1, 1 + height);
+		points.emplace_back(x, 1 + height);
+		points.emplace_back(x, 1.0f);
+	}
+	return points;
+}
+
+// Band of constant width winding around the center, many split and merge vertices
+std::vector<Vector2f> spiral(size_t turnSteps, size_t turns)
+{
+	std::vector<Vector2f> outer, inner;
+	const size_t count = turnSteps * turns;
+	for (size_t i = 0; i <= count; i++)
+	{
+		const float a = 6.28318531f * float(i) / float(turnSteps);
+		outer.emplace_back((1.0f + a) * std::cos(a), (1.0f + a) * std::sin(a));
+		inner.emplace_back((0.5f + a) * std::cos(a), (0.5f + a) * std::sin(a));
+	}
+	std::vector<Vector2f> points(outer.begin(), outer.end());
+	points.insert(points.end(), inner.rbegin(), inner.rend());
+	return points;
+}
+
+// Staircase on the integer grid, runs of collinear vertices along its steps
+std::vector<Vector2f> staircase(std::mt19937& gen, size_t steps)
+{
+	std::vector<Vector2f> points{ { 0.0f, 0.0f } };
+	float x = 0, y = 0;
+	for (size_t i = 0; i < steps; i++)
+	{
+		const float run = float(1 + gen() % 3);
+		for (float s = 1; s <= run; s++)
+		{
+			points.emplace_back(x + s, y);
+		}
+		x += run;
+		y += float(1 + gen() % 3);
+		points.emplace_back(x, y);
+	}
+	points.emplace_back(0.0f, y);
+	return points;
+}
+
+// Holes in a cells x cells grid inside a square, or a star around it, each a star or an
+// integer square in either orientation, squares share y values with their row and the outer ring
+void holedPolygon(std::mt19937& gen, size_t cells, bool starOutline,
+				  std::vector<Vector2f>& outPoints, std::vector<size_t>& outRingOffsets)
+{
+	const float size = float(4 * cells);
+	outPoints = starOutline
+		? star(gen, 8 * cells, Vector2f(size / 2, size / 2), size)
+		: std::vector<Vector2f>{ { 0, 0 }, { size, 0 }, { size, size }, { 0, size } };
+	outRingOffsets.assign(1, 0);
+	// A star outline reaches in to a fifth of its radius, holes stay in the cells it covers
+	const size_t first = starOutline ? cells * 2 / 5 : 0;
+	const size_t last = starOutline ? cells - first : cells;
+	for (size_t row = first; row < last; row++)
+	{
+		for (size_t col = first; col < last; col++)
+		{
+			const Vector2f corner(float(4 * col), float(4 * row));
+			std::vector<Vector2f> hole = gen() % 2
+				? star(gen, 3 + gen() % 12, Vector2f(corner.x + 2, corner.y + 2), 1.5f)
+				: std::vector<Vector2f>{ corner + Vector2f(1, 1), corner + Vector2f(3, 1),
+										 corner + Vector2f(3, 3), corner + Vector2f(1, 3) };
+			if (gen() % 2)
+			{
+				std::reverse(hole.begin(), hole.end());
+			}
+			outRingOffsets.push_back(outPoints.size());
+			outPoints.insert(outPoints.end(), hole.begin(), hole.end());
+		}
+	}
+}
+
+}
+
+int main()
+{
+	bool ok = true;
+
+	std::mt19937 gen(1);
+	for (Algorithm algorithm : { Algorithm::MonotonePartition, Algorithm::EarClipping, Algorithm::Auto })
+	{
+		for (int round = 0; round < 20; round++)
+		{
+			for (size_t n : { 3, 5, 16, 63, 64, 200 })
+			{
+				ok &= check(triangulatesBothWays(star(gen, n), algorithm), "star");
+			}
+			ok &= check(triangulatesBothWays(comb(gen, 1 + round), algorithm), "comb");
+			ok &= check(triangulatesBothWays(staircase(gen, 1 + 2 * round), algorithm), "staircase");
+		}
+		ok &= check(triangulatesBothWays(spiral(32, 3), algorithm), "spiral");
+	}
+
+	// Ear clipping and Auto take the sweep for polygons with holes
+	for (Algorithm algorithm : { Algorithm::MonotonePartition, Algorithm::EarClipping, Algorithm::Auto })
+	{
+		for (int round = 0; round < 10; round++)
+		{
+			std::vector<Vector2f> points;
+			std::vector<size_t> ringOffsets;
+			holedPolygon(gen, 1 + round, false, points, ringOffsets);
+			ok &= check(triangulatesWithHoles(points, ringOffsets, algorithm), "square with holes");
+			holedPolygon(gen, 5 + round, true, points, ringOffsets);
+			ok &= check(triangulatesWithHoles(points, ringOffsets, algorithm), "star with holes");
+		}
+	}
+
+	// Several blocks of polygons of mixed kinds and sizes, with and without holes
+	for (Algorithm algorithm : { Algorithm::MonotonePartition, Algorithm::EarClipping, Algorithm::Auto })
+	{
+		std::vector<Polygon> polygons;
+		for (int i = 0; i < 300; i++)
+		{
+			Polygon polygon;
+			switch (i % 4)
+			{
+			case 0: polygon.points = star(gen, 3 + gen() % 100); break;
+			case 1: polygon.points = comb(gen, 1 + gen() % 8); break;
+			case 2: polygon.points = staircase(gen, 1 + gen() % 10); break;
+			default: holedPolygon(gen, 1 + gen() % 3, false, polygon.points, polygon.ringOffsets); break;
+			}
+			// Holed polygons come in both orientations already
+			if (polygon.ringOffsets.empty())
+			{
+				polygon.ringOffsets.push_back(0);
+				if (gen() % 2)
+				{
+					std::reverse(polygon.points.begin(), polygon.points.end());
+				}
+			}
+			polygons.push_back(polygon);
+		}
+		ok &= check(batchMatchesSingle(polygons, algorithm), "batch");
+	}
+
+	const size_t autoLimit = PolygonTriangulation::cEarClippingMaxSize;
+	ok &= check(autoPicksBySize(star(gen, autoLimit - 1)), "auto below the limit");
+	ok &= check(autoPicksBySize(star(gen, autoLimit)), "auto at the limit");
+
+	std::printf(ok ? "passed\n" : "failed\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Radix sort against std::stable_sort on float and lexicographic point keys,
+// with repeated keys, signed zeros, infinities and NaNs, for several thread counts
+// Returns non-zero on the first mismatch
+
+#include "RadixSort.h"
+
+#include <cstdio>
+#include <limits>
+#include <random>
+
+namespace
+{
+
+bool check(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", what);
+	}
+	return condition;
+}
+
+// Same keys and ids in the same order as the stable comparison sort
+template <typename KeyT>
+bool matchesStableSort(const std::vector<Utils::KeyedId<KeyT>>& items)
+{
+	std::vector<Utils::KeyedId<KeyT>> expected = items;
+	std::stable_sort(expected.begin(), expected.end(), [](const Utils::KeyedId<KeyT>& a, const Utils::KeyedId<KeyT>& b)
+	{
+		return a.key < b.key;
+	});
+	for (size_t threadCount : { 1, 4 })
+	{
+		std::vector<Utils::KeyedId<KeyT>> sorted = items;
+		Utils::radixSort(sorted, threadCount);
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			if (sorted[i].key != expected[i].key || sorted[i].id != expected[i].id)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Floats drawn mostly from a few special values, so every key repeats
+float specialFloat(std::mt19937& gen)
+{
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float values[] = {
+		0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f,
+		std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+		std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+		std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min(),
+		nan, -nan
+	};
+	const size_t valueCount = sizeof(values) / sizeof(values[0]);
+	const size_t pick = gen() % (valueCount + 2);
+	if (pick < valueCount)
+	{
+		return values[pick];
+	}
+	return std::uniform_real_distribution<float>(-100.0f, 100.0f)(gen);
+}
+
+}
+
+int main()
+{
+	bool ok = true;
+
+	// Keys follow the float order, -0 and +0 share one, NaNs land beyond the infinities
+	const float ordered[] = {
+		-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::lowest(), -1.0f,
+		-std::numeric_limits<float>::denorm_min(), 0.0f, std::numeric_limits<float>::denorm_min(), 1.0f,
+		std::numeric_limits<float>::max(), std::numeric_limits<float>::infinity()
+	};
+	for (size_t i = 1; i < sizeof(ordered) / sizeof(ordered[0]); i++)
+	{
+		ok &= check(Utils::sortableBits(ordered[i - 1]) < Utils::sortableBits(ordered[i]), "float order");
+	}
+	for (float value : ordered)
+	{
+		ok &= check(Utils::fromSortableBits(Utils::sortableBits(value)) == value, "round trip");
+	}
+	ok &= check(Utils::sortableBits(-0.0f) == Utils::sortableBits(0.0f), "signed zeros");
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	ok &= check(Utils::sortableBits(nan) > Utils::sortableBits(std::numeric_limits<float>::infinity()), "NaN");
+	ok &= check(Utils::sortableBits(-nan) < Utils::sortableBits(-std::numeric_limits<float>::infinity()), "-NaN");
+
+	std::mt19937 gen(1);
+	// Around the comparison sort cutoff, and enough for several chunks with 4 threads
+	for (size_t count : { 0, 1, 1023, 1024, 5000, 300000 })
+	{
+		std::vector<Utils::KeyedId<uint32_t>> floatKeys(count);
+		std::vector<Utils::KeyedId<uint64_t>> pointKeys(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			floatKeys[i] = { Utils::sortableBits(specialFloat(gen)), i };
+			pointKeys[i] = { Utils::lexicographicKey(Vector2f(specialFloat(gen), specialFloat(gen))), i };
+		}
+		ok &= check(matchesStableSort(floatKeys), "float keys");
+		ok &= check(matchesStableSort(pointKeys), "point keys");
+
+		// Keys sharing all but their lowest digit, and one key for all, skip passes
+		for (size_t i = 0; i < count; i++)
+		{
+			floatKeys[i].key = 0x80000000u | static_cast<uint32_t>(gen() % 3);
+			pointKeys[i].key = 0x7F00000012345678ull;
+		}
+		ok &= check(matchesStableSort(floatKeys), "keys differing in one digit");
+		ok &= check(matchesStableSort(pointKeys), "one key");
+	}
+
+	std::printf(ok ? "passed\n" : "failed\n");
+	return ok ? 0 : 1;
+}